@@ -23,6 +23,13 @@ ttest(byte_stream_one_write)
 ttest(byte_stream_two_writes)
 ttest(byte_stream_many_writes)
 ttest(byte_stream_stress_test)
+ttest(byte_stream_chunked)
+ttest(byte_stream_mirrored)
+ttest(byte_stream_pooled)
+ttest(byte_stream_static)
+ttest(byte_stream_spsc)
+ttest(byte_stream_readiness)
+ttest(byte_stream_splice)
 
 ttest(reassembler_single)
 ttest(reassembler_cap)
@@ -31,6 +38,11 @@ ttest(reassembler_dup)
 ttest(reassembler_holes)
 ttest(reassembler_overlapping)
 ttest(reassembler_win)
+ttest(reassembler_windowed)
+ttest(reassembler_slices)
+ttest(reassembler_batch)
+ttest(reassembler_sack)
+ttest(reassembler_budget)
 
 ttest(wrapping_integers_cmp)
 ttest(wrapping_integers_wrap)
@@ -45,6 +57,8 @@ ttest(recv_reorder)
 ttest(recv_reorder_more)
 ttest(recv_close)
 ttest(recv_special)
+ttest(recv_sack)
+ttest(recv_window_scale)
 
 ttest(send_connect)
 ttest(send_transmit)
@@ -53,6 +67,13 @@ ttest(send_window)
 ttest(send_ack)
 ttest(send_close)
 ttest(send_extra)
+ttest(send_congestion)
+ttest(send_rtt)
+ttest(send_fast_retx)
+ttest(send_sack)
+ttest(send_pacing)
+ttest(send_ring)
+ttest(send_window_scale)
 
 ttest(net_interface)
 
@@ -89,4 +110,8 @@ set_property(TEST ${compile_name_opt} PROPERTY TIMEOUT -1)
 set_tests_properties(${compile_name_opt} PROPERTIES FIXTURES_SETUP compile_opt)
 
 stest(byte_stream_speed_test)
+stest(byte_stream_spsc_speed_test)
 stest(reassembler_speed_test)
+stest(reassembler_batch_speed_test)
+stest(reassembler_patterns_speed_test)
+stest(send_ack_speed_test)
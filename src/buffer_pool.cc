@@ -0,0 +1,36 @@
+#include "buffer_pool.hh"
+
+#include <algorithm>
+#include <stdexcept>
+
+using namespace std;
+
+BufferPool::BufferPool( size_t chunk_size, size_t chunks_per_slab )
+  : chunk_size_( chunk_size ), chunks_per_slab_( chunks_per_slab )
+{
+  if ( chunk_size_ == 0 or chunks_per_slab_ == 0 ) {
+    throw runtime_error( "BufferPool: chunk size and chunks per slab must be positive" );
+  }
+}
+
+char* BufferPool::borrow()
+{
+  if ( free_chunks_.empty() ) {
+    auto& slab = slabs_.emplace_back( make_unique_for_overwrite<char[]>( chunk_size_ * chunks_per_slab_ ) );
+    for ( size_t i = chunks_per_slab_; i > 0; --i ) {
+      free_chunks_.push_back( slab.get() + ( i - 1 ) * chunk_size_ );
+    }
+  }
+
+  char* const chunk = free_chunks_.back();
+  free_chunks_.pop_back();
+  ++chunks_in_use_;
+  peak_chunks_in_use_ = max( peak_chunks_in_use_, chunks_in_use_ );
+  return chunk;
+}
+
+void BufferPool::give_back( char* chunk )
+{
+  free_chunks_.push_back( chunk );
+  --chunks_in_use_;
+}
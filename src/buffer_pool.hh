@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+/*
+ * A slab allocator of fixed-size chunks, shared by many ByteStreams (see ByteStream::pooled()).
+ *
+ * Streams borrow chunks only while they hold data and give them back as soon as they are drained,
+ * so idle streams cost no buffer memory. Chunks are carved out of slabs of `chunks_per_slab` chunks;
+ * slabs are kept for reuse until the pool is destroyed. The pool is not thread-safe.
+ */
+class BufferPool
+{
+  size_t chunk_size_;
+  size_t chunks_per_slab_;
+  std::vector<std::unique_ptr<char[]>> slabs_ {};
+  std::vector<char*> free_chunks_ {};
+  size_t chunks_in_use_ = 0;
+  size_t peak_chunks_in_use_ = 0;
+
+public:
+  static constexpr size_t DEFAULT_CHUNK_SIZE = 4096;
+  static constexpr size_t DEFAULT_CHUNKS_PER_SLAB = 64;
+
+  explicit BufferPool( size_t chunk_size = DEFAULT_CHUNK_SIZE, size_t chunks_per_slab = DEFAULT_CHUNKS_PER_SLAB );
+
+  char* borrow();                // Take a chunk of chunk_size() bytes, allocating a new slab if none are free
+  void give_back( char* chunk ); // Return a chunk obtained from borrow()
+
+  /* Occupancy, for sizing the pool */
+  size_t chunk_size() const { return chunk_size_; }
+  size_t chunks_in_use() const { return chunks_in_use_; }                      // Chunks currently borrowed
+  size_t chunks_allocated() const { return slabs_.size() * chunks_per_slab_; } // Chunks backed by allocated slabs
+  size_t peak_chunks_in_use() const { return peak_chunks_in_use_; }            // High-water mark of chunks_in_use()
+};
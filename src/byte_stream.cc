@@ -1,32 +1,92 @@
+#include <climits>
 #include <stdexcept>
+#include <type_traits>
+#include <utility>
 
 #include "byte_stream.hh"
+#include "file_descriptor.hh"
 
 using namespace std;
 
-ByteStream::ByteStream( uint64_t capacity ) : capacity_( capacity ) {}
+ByteStream::ByteStream( uint64_t capacity ) : ByteStream( capacity, RingBuffer { capacity } ) {}
+
+ByteStream::ByteStream( uint64_t capacity, ByteStreamStorage storage )
+  : capacity_( capacity ), storage_( std::move( storage ) )
+{}
+
+ByteStream ByteStream::chunked( uint64_t capacity )
+{
+  return { capacity, ChunkQueue {} };
+}
+
+ByteStream ByteStream::mirrored( uint64_t capacity )
+{
+  return { capacity, MirroredRing { capacity } };
+}
+
+ByteStream ByteStream::pooled( uint64_t capacity, shared_ptr<BufferPool> pool )
+{
+  return { capacity, PooledBuffer { std::move( pool ) } };
+}
 
 void Writer::push( string data )
 {
-  if ( !is_closed() ) {
-    const uint64_t space = min( available_capacity(), data.size() );
-    uint64_t i = 0;
-    while ( i < space ) {
-      stream_.emplace( data[i] );
-      i++;
-    }
-    bytes_pushed_ += i;
+  if ( is_closed() ) {
+    return;
   }
+  const uint64_t len = min( available_capacity(), data.size() );
+  data.resize( len );
+  std::visit( [&]( auto& storage ) { storage.push( std::move( data ) ); }, storage_ );
+  add_pushed( len );
+}
+
+span<char> Writer::reserve( uint64_t len )
+{
+  if ( is_closed() ) {
+    return {};
+  }
+  len = min( len, available_capacity() );
+  return std::visit( [len]( auto& storage ) { return storage.reserve( len ); }, storage_ );
+}
+
+void Writer::commit( uint64_t len )
+{
+  std::visit( [len]( auto& storage ) { storage.commit( len ); }, storage_ );
+  add_pushed( len );
+}
+
+uint64_t Writer::push_from( FileDescriptor& source )
+{
+  if ( is_closed() || available_capacity() == 0 ) {
+    return 0;
+  }
+  const uint64_t len = std::visit(
+    [&]( auto& storage ) -> uint64_t {
+      if constexpr ( is_same_v<decay_t<decltype( storage )>, MirroredRing> ) {
+        return storage.splice_from( source, available_capacity() );
+      } else {
+        return source.read( storage.reserve( available_capacity() ) );
+      }
+    },
+    storage_ );
+  commit( len );
+  return len;
 }
 
 void Writer::close()
 {
-  is_closed_ = true;
+  const bool was_closed = std::exchange( is_closed_, true );
+  if ( !was_closed && on_closed_ ) {
+    on_closed_();
+  }
 }
 
 void Writer::set_error()
 {
-  has_error_ = true;
+  const bool had_error = std::exchange( has_error_, true );
+  if ( !had_error && on_closed_ ) {
+    on_closed_();
+  }
 }
 
 bool Writer::is_closed() const
@@ -36,7 +96,7 @@ bool Writer::is_closed() const
 
 uint64_t Writer::available_capacity() const
 {
-  return capacity_ - stream_.size();
+  return capacity_ - ( bytes_pushed_ - bytes_poped_ );
 }
 
 uint64_t Writer::bytes_pushed() const
@@ -44,12 +104,43 @@ uint64_t Writer::bytes_pushed() const
   return bytes_pushed_;
 }
 
+void Writer::on_writable( function<void()> callback, uint64_t low_water_mark )
+{
+  on_writable_ = std::move( callback );
+  writable_low_water_mark_ = max<uint64_t>( low_water_mark, 1 );
+}
+
 string_view Reader::peek() const
 {
-  if ( stream_.empty() ) {
-    return {};
+  return std::visit( []( const auto& storage ) { return storage.peek(); }, storage_ );
+}
+
+void Reader::peek( vector<string_view>& regions ) const
+{
+  std::visit( [&regions]( const auto& storage ) { storage.regions( regions ); }, storage_ );
+}
+
+uint64_t Reader::pop_to( FileDescriptor& sink )
+{
+  if ( bytes_buffered() == 0 ) {
+    return 0;
   }
-  return { &stream_.front(), 1 };
+  const uint64_t len = std::visit(
+    [&]( auto& storage ) -> uint64_t {
+      if constexpr ( is_same_v<decay_t<decltype( storage )>, MirroredRing> ) {
+        return storage.send_to( sink );
+      } else {
+        vector<string_view> regions;
+        storage.regions( regions );
+        if ( regions.size() > IOV_MAX ) {
+          regions.resize( IOV_MAX ); // writev() rejects longer iovec arrays
+        }
+        return sink.write( regions );
+      }
+    },
+    storage_ );
+  pop( len );
+  return len;
 }
 
 bool Reader::is_finished() const
@@ -64,20 +155,48 @@ bool Reader::has_error() const
 
 void Reader::pop( uint64_t len )
 {
-  uint64_t count = min( bytes_buffered(), len );
-  bytes_poped_ += count;
-  while ( count > 0 ) {
-    stream_.pop();
-    count--;
-  }
+  const uint64_t count = min( bytes_buffered(), len );
+  std::visit( [count]( auto& storage ) { storage.pop( count ); }, storage_ );
+  add_popped( count );
 }
 
 uint64_t Reader::bytes_buffered() const
 {
-  return stream_.size();
+  return bytes_pushed_ - bytes_poped_;
 }
 
 uint64_t Reader::bytes_popped() const
 {
   return bytes_poped_;
 }
+
+void Reader::on_readable( function<void()> callback, uint64_t low_water_mark )
+{
+  on_readable_ = std::move( callback );
+  readable_low_water_mark_ = max<uint64_t>( low_water_mark, 1 );
+}
+
+void Reader::on_closed( function<void()> callback )
+{
+  on_closed_ = std::move( callback );
+}
+
+void ByteStream::add_pushed( uint64_t len )
+{
+  const uint64_t buffered_before = bytes_pushed_ - bytes_poped_;
+  bytes_pushed_ += len;
+  if ( on_readable_ && buffered_before < readable_low_water_mark_
+       && buffered_before + len >= readable_low_water_mark_ ) {
+    on_readable_();
+  }
+}
+
+void ByteStream::add_popped( uint64_t len )
+{
+  const uint64_t available_before = capacity_ - ( bytes_pushed_ - bytes_poped_ );
+  bytes_poped_ += len;
+  if ( on_writable_ && available_before < writable_low_water_mark_
+       && available_before + len >= writable_low_water_mark_ ) {
+    on_writable_();
+  }
+}
@@ -1,11 +1,18 @@
 #pragma once
 
+#include "byte_stream_storage.hh"
+
 #include <cstdint>
-#include <queue>
+#include <functional>
+#include <memory>
+#include <span>
 #include <stdexcept>
 #include <string>
 #include <string_view>
+#include <utility>
+#include <vector>
 
+class FileDescriptor;
 class Reader;
 class Writer;
 
@@ -14,14 +21,44 @@ class ByteStream
 protected:
   uint64_t capacity_;
   // Please add any additional state to the ByteStream here, and not to the Writer and Reader interfaces.
-  std::queue<char> stream_ {};
+  ByteStreamStorage storage_;
   bool is_closed_ = false;
   bool has_error_ = false;
   uint64_t bytes_poped_ = 0;
   uint64_t bytes_pushed_ = 0;
 
+  // Optional readiness notifications (see Reader::on_readable(), Writer::on_writable() and Reader::on_closed())
+  std::function<void()> on_readable_ {};
+  std::function<void()> on_writable_ {};
+  std::function<void()> on_closed_ {};
+  uint64_t readable_low_water_mark_ = 1;
+  uint64_t writable_low_water_mark_ = 1;
+
+  ByteStream( uint64_t capacity, ByteStreamStorage storage );
+
+  void add_pushed( uint64_t len ); // Count newly pushed bytes and notify the reader if they cross its mark
+  void add_popped( uint64_t len ); // Count newly popped bytes and notify the writer if they cross its mark
+
+  // Construct the storage backend in place (for backends that point into the derived object, e.g. FixedRing)
+  template<typename Storage, typename... Args>
+  ByteStream( uint64_t capacity, std::in_place_type_t<Storage> storage_type, Args&&... args )
+    : capacity_( capacity ), storage_( storage_type, std::forward<Args>( args )... )
+  {}
+
 public:
-  explicit ByteStream( uint64_t capacity );
+  explicit ByteStream( uint64_t capacity ); // Copies pushed bytes into a preallocated ring buffer
+
+  // A ByteStream that keeps pushed strings as owned chunks instead of copying their bytes.
+  // Data that doesn't fit is trimmed from the end of the pushed string; peek() returns the rest of the front chunk.
+  static ByteStream chunked( uint64_t capacity );
+
+  // A ByteStream backed by a ring that is mapped twice in a row in virtual memory (Linux only).
+  // peek() always returns every buffered byte as a single view, even across the wrap point.
+  static ByteStream mirrored( uint64_t capacity );
+
+  // A ByteStream that borrows fixed-size chunks from a shared `pool` only while it holds data.
+  // Idle streams hold no buffer memory; peek() returns the rest of the front chunk.
+  static ByteStream pooled( uint64_t capacity, std::shared_ptr<BufferPool> pool );
 
   // Helper functions (provided) to access the ByteStream's Reader and Writer interfaces
   Reader& reader();
@@ -35,12 +72,28 @@ class Writer : public ByteStream
 public:
   void push( std::string data ); // Push data to stream, but only as much as available capacity allows.
 
+  // Fill the stream in place: reserve() returns a writable span of at most `len` bytes (fewer if capacity is short
+  // or the free space isn't contiguous), and commit() pushes the first `len` bytes written into that span.
+  // `len` in commit() must not exceed the size of the span from the preceding reserve().
+  // Ring-backed streams hand out their own free space and never allocate; a chunked stream reuses the last chunk
+  // popped when it is big enough, and otherwise allocates a new chunk.
+  std::span<char> reserve( uint64_t len );
+  void commit( uint64_t len );
+
+  // Push bytes read from `source` (one read or splice, up to the available capacity); returns how many.
+  // Mirrored streams splice straight into their memfd, so the bytes never pass through user space.
+  uint64_t push_from( FileDescriptor& source );
+
   void close();     // Signal that the stream has reached its ending. Nothing more will be written.
   void set_error(); // Signal that the stream suffered an error.
 
   bool is_closed() const;              // Has the stream been closed?
   uint64_t available_capacity() const; // How many bytes can be pushed to the stream right now?
   uint64_t bytes_pushed() const;       // Total number of bytes cumulatively pushed to the stream
+
+  // Call `callback` each time available_capacity() rises from below `low_water_mark` to at least `low_water_mark`
+  // (so a producer can sleep while the stream is full and is woken once, not per popped byte).
+  void on_writable( std::function<void()> callback, uint64_t low_water_mark = 1 );
 };
 
 class Reader : public ByteStream
@@ -49,11 +102,24 @@ public:
   std::string_view peek() const; // Peek at the next bytes in the buffer
   void pop( uint64_t len );      // Remove `len` bytes from the buffer
 
+  // Append views of *all* buffered bytes, in order, to `regions` (e.g. to hand to a single writev).
+  // The views stay valid until the next push() or pop().
+  void peek( std::vector<std::string_view>& regions ) const;
+
+  // Write buffered bytes to `sink` (one writev or sendfile) and pop them; returns how many.
+  // Mirrored streams sendfile from their memfd, so the bytes never pass through user space.
+  uint64_t pop_to( FileDescriptor& sink );
+
   bool is_finished() const; // Is the stream finished (closed and fully popped)?
   bool has_error() const;   // Has the stream had an error?
 
   uint64_t bytes_buffered() const; // Number of bytes currently buffered (pushed and not popped)
   uint64_t bytes_popped() const;   // Total number of bytes cumulatively popped from stream
+
+  // Call `callback` each time bytes_buffered() rises from below `low_water_mark` to at least `low_water_mark`.
+  void on_readable( std::function<void()> callback, uint64_t low_water_mark = 1 );
+  // Call `callback` when the stream is first closed, and when an error is first set.
+  void on_closed( std::function<void()> callback );
 };
 
 /*
@@ -61,3 +127,9 @@ public:
  * from a ByteStream Reader into a string;
  */
 void read( Reader& reader, uint64_t len, std::string& out );
+
+/*
+ * write: A helper function that copies as much of `data` as fits straight into the Writer's storage
+ * (no intermediate string) and returns how many bytes were pushed.
+ */
+uint64_t write( Writer& writer, std::string_view data );
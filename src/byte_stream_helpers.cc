@@ -1,5 +1,7 @@
 #include "byte_stream.hh"
 
+#include <algorithm>
+#include <cstddef>
 #include <cstdint>
 #include <stdexcept>
 
@@ -24,6 +26,25 @@ void read( Reader& reader, uint64_t len, std::string& out )
   }
 }
 
+/*
+ * write: A helper function that copies as much of `data` as fits straight into the Writer's storage
+ * (no intermediate string) and returns how many bytes were pushed.
+ */
+uint64_t write( Writer& writer, std::string_view data )
+{
+  uint64_t written = 0;
+  while ( written < data.size() ) {
+    const auto span = writer.reserve( data.size() - written ); // may stop short where the free space wraps
+    if ( span.empty() ) {
+      break;
+    }
+    std::copy_n( data.begin() + static_cast<std::ptrdiff_t>( written ), span.size(), span.begin() );
+    writer.commit( span.size() );
+    written += span.size();
+  }
+  return written;
+}
+
 Reader& ByteStream::reader()
 {
   static_assert( sizeof( Reader ) == sizeof( ByteStream ),
@@ -0,0 +1,468 @@
+#include "byte_stream_storage.hh"
+#include "exception.hh"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <utility>
+
+using namespace std;
+
+void RingBuffer::push( string data )
+{
+  // The free region may wrap around the end of the ring: fill up to the end, then continue from the start.
+  const auto first_part = reserve( data.size() );
+  if ( first_part.empty() ) {
+    return;
+  }
+  memcpy( first_part.data(), data.data(), first_part.size() );
+  memcpy( buffer_.data(), data.data() + first_part.size(), data.size() - first_part.size() );
+
+  size_ += data.size();
+}
+
+span<char> RingBuffer::reserve( uint64_t len )
+{
+  const uint64_t capacity = buffer_.size();
+  uint64_t tail = head_ + size_;
+  if ( tail >= capacity ) {
+    tail -= capacity;
+  }
+  // Free bytes run from the tail to whichever comes first: the head, or the end of the ring.
+  const uint64_t contiguous = tail < head_ ? head_ - tail : capacity - tail;
+  return { buffer_.data() + tail, min( { len, contiguous, capacity - size_ } ) };
+}
+
+void RingBuffer::commit( uint64_t len )
+{
+  size_ += len;
+}
+
+string_view RingBuffer::peek() const
+{
+  return { buffer_.data() + head_, min( size_, buffer_.size() - head_ ) };
+}
+
+void RingBuffer::regions( vector<string_view>& out ) const
+{
+  const string_view front = peek();
+  if ( !front.empty() ) {
+    out.push_back( front );
+  }
+  if ( front.size() < size_ ) {
+    out.emplace_back( buffer_.data(), size_ - front.size() );
+  }
+}
+
+void RingBuffer::pop( uint64_t len )
+{
+  size_ -= len;
+  if ( size_ == 0 ) {
+    // Rewind an empty ring so the next push (and peek) is contiguous from the start.
+    head_ = 0;
+    return;
+  }
+  head_ += len;
+  if ( head_ >= buffer_.size() ) {
+    head_ -= buffer_.size();
+  }
+}
+
+void ChunkQueue::push( string data )
+{
+  if ( !data.empty() ) {
+    chunks_.push_back( std::move( data ) );
+  }
+}
+
+span<char> ChunkQueue::reserve( uint64_t len )
+{
+  // While the reader keeps up, the chunk it just finished has room for the next one: reuse it.
+  if ( reserved_.capacity() < len && spare_.capacity() >= len ) {
+    swap( reserved_, spare_ );
+  }
+  reserved_.resize( len );
+  return reserved_;
+}
+
+void ChunkQueue::commit( uint64_t len )
+{
+  reserved_.resize( len );
+  push( std::move( reserved_ ) );
+  reserved_.clear();
+}
+
+string_view ChunkQueue::peek() const
+{
+  if ( chunks_.empty() ) {
+    return {};
+  }
+  return string_view { chunks_.front() }.substr( front_offset_ );
+}
+
+void ChunkQueue::regions( vector<string_view>& out ) const
+{
+  uint64_t offset = front_offset_;
+  for ( const auto& chunk : chunks_ ) {
+    out.push_back( string_view { chunk }.substr( offset ) );
+    offset = 0;
+  }
+}
+
+void ChunkQueue::pop( uint64_t len )
+{
+  while ( len > 0 ) {
+    const uint64_t remaining = chunks_.front().size() - front_offset_;
+    if ( len < remaining ) {
+      front_offset_ += len;
+      return;
+    }
+    len -= remaining;
+    spare_ = std::move( chunks_.front() );
+    chunks_.pop_front();
+    front_offset_ = 0;
+  }
+}
+
+namespace {
+
+uint64_t round_up_to_pages( uint64_t capacity )
+{
+  const auto page_size = static_cast<uint64_t>( sysconf( _SC_PAGESIZE ) );
+  return max( page_size, ( capacity + page_size - 1 ) / page_size * page_size );
+}
+
+} // namespace
+
+MirroredRing::MirroredRing( uint64_t capacity )
+  : memfd_( CheckSystemCall( "memfd_create", memfd_create( "ByteStream", MFD_CLOEXEC ) ) )
+  , ring_size_( round_up_to_pages( capacity ) )
+{
+  CheckSystemCall( "ftruncate", ftruncate( memfd_.fd_num(), static_cast<off_t>( ring_size_ ) ) );
+
+  // Reserve twice the ring's size of address space, then map the memfd over each half.
+  void* const reserved = mmap( nullptr, 2 * ring_size_, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0 );
+  if ( reserved == MAP_FAILED ) {
+    throw unix_error { "mmap" };
+  }
+  base_ = static_cast<char*>( reserved );
+
+  for ( char* const half : { base_, base_ + ring_size_ } ) {
+    if ( mmap( half, ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, memfd_.fd_num(), 0 )
+         == MAP_FAILED ) {
+      const unix_error error { "mmap" };
+      munmap( base_, 2 * ring_size_ );
+      throw error;
+    }
+  }
+}
+
+MirroredRing::~MirroredRing()
+{
+  if ( base_ ) {
+    munmap( base_, 2 * ring_size_ );
+  }
+}
+
+MirroredRing::MirroredRing( const MirroredRing& other ) : MirroredRing( other.ring_size_ )
+{
+  memcpy( base_, other.base_ + other.head_, other.size_ );
+  size_ = other.size_;
+}
+
+MirroredRing& MirroredRing::operator=( const MirroredRing& other )
+{
+  if ( this != &other ) {
+    *this = MirroredRing { other };
+  }
+  return *this;
+}
+
+MirroredRing::MirroredRing( MirroredRing&& other ) noexcept
+  : memfd_( std::move( other.memfd_ ) )
+  , ring_size_( other.ring_size_ )
+  , base_( std::exchange( other.base_, nullptr ) )
+  , head_( other.head_ )
+  , size_( other.size_ )
+  , pipe_read_( std::move( other.pipe_read_ ) )
+  , pipe_write_( std::move( other.pipe_write_ ) )
+{}
+
+MirroredRing& MirroredRing::operator=( MirroredRing&& other ) noexcept
+{
+  swap( memfd_, other.memfd_ );
+  swap( ring_size_, other.ring_size_ );
+  swap( base_, other.base_ );
+  swap( head_, other.head_ );
+  swap( size_, other.size_ );
+  swap( pipe_read_, other.pipe_read_ );
+  swap( pipe_write_, other.pipe_write_ );
+  return *this;
+}
+
+void MirroredRing::push( string data )
+{
+  // The region past the end of the first mapping is the start of the ring, so one copy always suffices.
+  memcpy( reserve( data.size() ).data(), data.data(), data.size() );
+  size_ += data.size();
+}
+
+span<char> MirroredRing::reserve( uint64_t len )
+{
+  return { base_ + head_ + size_, min( len, ring_size_ - size_ ) };
+}
+
+void MirroredRing::commit( uint64_t len )
+{
+  size_ += len;
+}
+
+string_view MirroredRing::peek() const
+{
+  return { base_ + head_, size_ };
+}
+
+void MirroredRing::regions( vector<string_view>& out ) const
+{
+  if ( size_ > 0 ) {
+    out.push_back( peek() );
+  }
+}
+
+void MirroredRing::pop( uint64_t len )
+{
+  size_ -= len;
+  head_ += len;
+  if ( head_ >= ring_size_ ) {
+    head_ -= ring_size_;
+  }
+}
+
+uint64_t MirroredRing::splice_from( FileDescriptor& source, uint64_t len )
+{
+  if ( !pipe_read_.has_value() ) {
+    array<int, 2> fds {};
+    CheckSystemCall( "pipe2", pipe2( fds.data(), O_CLOEXEC ) );
+    pipe_read_.emplace( fds[0] );
+    pipe_write_.emplace( fds[1] );
+  }
+
+  // A splice can't wrap around the end of the memfd, so stop there; the next call continues at offset 0.
+  uint64_t tail = head_ + size_;
+  if ( tail >= ring_size_ ) {
+    tail -= ring_size_;
+  }
+  len = min( { len, ring_size_ - size_, ring_size_ - tail } );
+
+  const uint64_t staged = source.splice( *pipe_write_, len );
+  for ( uint64_t moved = 0; moved < staged; ) {
+    moved += pipe_read_->splice( memfd_, staged - moved, static_cast<off_t>( tail + moved ) );
+  }
+  return staged;
+}
+
+uint64_t MirroredRing::send_to( FileDescriptor& sink )
+{
+  if ( size_ == 0 ) {
+    return 0;
+  }
+  // Like splice_from(), one call stops at the end of the memfd.
+  return sink.sendfile( memfd_, static_cast<off_t>( head_ ), min( size_, ring_size_ - head_ ) );
+}
+
+PooledBuffer::PooledBuffer( shared_ptr<BufferPool> pool ) : pool_( std::move( pool ) ) {}
+
+PooledBuffer::~PooledBuffer()
+{
+  for ( char* const chunk : chunks_ ) {
+    pool_->give_back( chunk );
+  }
+}
+
+PooledBuffer::PooledBuffer( const PooledBuffer& other ) : pool_( other.pool_ )
+{
+  vector<string_view> other_regions;
+  other.regions( other_regions );
+  for ( const auto region : other_regions ) {
+    append( region );
+  }
+}
+
+PooledBuffer& PooledBuffer::operator=( const PooledBuffer& other )
+{
+  if ( this != &other ) {
+    *this = PooledBuffer { other };
+  }
+  return *this;
+}
+
+PooledBuffer::PooledBuffer( PooledBuffer&& other ) noexcept
+  : pool_( other.pool_ )
+  , chunks_( std::exchange( other.chunks_, {} ) )
+  , head_( std::exchange( other.head_, 0 ) )
+  , size_( std::exchange( other.size_, 0 ) )
+{}
+
+PooledBuffer& PooledBuffer::operator=( PooledBuffer&& other ) noexcept
+{
+  swap( pool_, other.pool_ );
+  swap( chunks_, other.chunks_ );
+  swap( head_, other.head_ );
+  swap( size_, other.size_ );
+  return *this;
+}
+
+void PooledBuffer::push( string data )
+{
+  append( data );
+}
+
+void PooledBuffer::append( string_view remaining )
+{
+  while ( !remaining.empty() ) {
+    const auto span = reserve( remaining.size() );
+    memcpy( span.data(), remaining.data(), span.size() );
+    commit( span.size() );
+    remaining.remove_prefix( span.size() );
+  }
+}
+
+span<char> PooledBuffer::reserve( uint64_t len )
+{
+  if ( len == 0 ) {
+    return {};
+  }
+  const uint64_t chunk_size = pool_->chunk_size();
+  const uint64_t tail = head_ + size_; // offset of the first free byte from the start of chunks_.front()
+  if ( tail == chunks_.size() * chunk_size ) {
+    chunks_.push_back( pool_->borrow() );
+  }
+  const uint64_t offset = tail % chunk_size;
+  return { chunks_[tail / chunk_size] + offset, min( len, chunk_size - offset ) };
+}
+
+void PooledBuffer::commit( uint64_t len )
+{
+  size_ += len;
+  give_back_unused();
+}
+
+string_view PooledBuffer::peek() const
+{
+  if ( size_ == 0 ) {
+    return {};
+  }
+  return { chunks_.front() + head_, min( size_, pool_->chunk_size() - head_ ) };
+}
+
+void PooledBuffer::regions( vector<string_view>& out ) const
+{
+  uint64_t offset = head_;
+  uint64_t remaining = size_;
+  for ( auto it = chunks_.begin(); remaining > 0; ++it ) {
+    const uint64_t len = min( remaining, pool_->chunk_size() - offset );
+    out.emplace_back( *it + offset, len );
+    remaining -= len;
+    offset = 0;
+  }
+}
+
+void PooledBuffer::pop( uint64_t len )
+{
+  const uint64_t chunk_size = pool_->chunk_size();
+  size_ -= len;
+  head_ += len;
+  while ( head_ >= chunk_size ) {
+    pool_->give_back( chunks_.front() );
+    chunks_.pop_front();
+    head_ -= chunk_size;
+  }
+  give_back_unused();
+}
+
+void PooledBuffer::give_back_unused()
+{
+  if ( size_ == 0 ) {
+    head_ = 0;
+  }
+  const uint64_t chunk_size = pool_->chunk_size();
+  const uint64_t chunks_needed = ( head_ + size_ + chunk_size - 1 ) / chunk_size;
+  while ( chunks_.size() > chunks_needed ) {
+    pool_->give_back( chunks_.back() );
+    chunks_.pop_back();
+  }
+}
+
+FixedRing::FixedRing( span<char> storage ) : data_( storage.data() ), mask_( storage.size() - 1 ) {}
+
+FixedRing::FixedRing( const FixedRing& other )
+  : owned_( make_unique_for_overwrite<char[]>( other.mask_ + 1 ) ), data_( owned_.get() ), mask_( other.mask_ )
+{
+  *this = other;
+}
+
+FixedRing& FixedRing::operator=( const FixedRing& other )
+{
+  if ( this == &other ) {
+    return *this;
+  }
+  if ( mask_ != other.mask_ ) {
+    owned_ = make_unique_for_overwrite<char[]>( other.mask_ + 1 );
+    data_ = owned_.get();
+    mask_ = other.mask_;
+  }
+  head_ = 0;
+  size_ = 0;
+  vector<string_view> other_regions;
+  other.regions( other_regions );
+  for ( const auto region : other_regions ) {
+    memcpy( data_ + size_, region.data(), region.size() );
+    size_ += region.size();
+  }
+  return *this;
+}
+
+void FixedRing::push( string data )
+{
+  const auto first_part = reserve( data.size() );
+  memcpy( first_part.data(), data.data(), first_part.size() );
+  memcpy( data_, data.data() + first_part.size(), data.size() - first_part.size() );
+  size_ += data.size();
+}
+
+span<char> FixedRing::reserve( uint64_t len )
+{
+  const uint64_t tail = ( head_ + size_ ) & mask_;
+  const uint64_t contiguous = ( tail < head_ || size_ > mask_ ) ? head_ - tail : mask_ + 1 - tail;
+  return { data_ + tail, min( len, contiguous ) };
+}
+
+void FixedRing::commit( uint64_t len )
+{
+  size_ += len;
+}
+
+string_view FixedRing::peek() const
+{
+  return { data_ + head_, min( size_, mask_ + 1 - head_ ) };
+}
+
+void FixedRing::regions( vector<string_view>& out ) const
+{
+  const string_view front = peek();
+  if ( !front.empty() ) {
+    out.push_back( front );
+  }
+  if ( front.size() < size_ ) {
+    out.emplace_back( data_, size_ - front.size() );
+  }
+}
+
+void FixedRing::pop( uint64_t len )
+{
+  size_ -= len;
+  head_ = ( head_ + len ) & mask_;
+}
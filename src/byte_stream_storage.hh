@@ -0,0 +1,162 @@
+#pragma once
+
+#include "buffer_pool.hh"
+#include "file_descriptor.hh"
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+/*
+ * Storage backends for the bytes held by a ByteStream.
+ *
+ * The ByteStream itself keeps the accounting (capacity, bytes pushed/popped, closed/error flags)
+ * and guarantees that a backend is never asked to hold more than `capacity` bytes or to pop more
+ * bytes than it holds. Every backend offers the same small interface:
+ *
+ *   push( data )      -- append all of `data`
+ *   reserve( len )    -- a writable span of at most `len` bytes (possibly fewer) at the end
+ *   commit( len )     -- append the first `len` bytes written into the span from the last reserve()
+ *   peek()            -- a contiguous view of the bytes at the front (empty iff nothing is stored)
+ *   regions( out )    -- append views of all stored bytes, in order, to `out`
+ *   pop( len )        -- discard `len` bytes from the front
+ */
+
+// A preallocated, capacity-sized ring. Pushes copy into the ring; pops only move an index.
+class RingBuffer
+{
+  std::vector<char> buffer_;
+  uint64_t head_ = 0; // index in buffer_ of the next byte to be popped
+  uint64_t size_ = 0; // number of bytes currently stored
+
+public:
+  explicit RingBuffer( uint64_t capacity ) : buffer_( capacity ) {}
+
+  void push( std::string data );
+  std::span<char> reserve( uint64_t len ); // Stops at the end of the ring
+  void commit( uint64_t len );
+  std::string_view peek() const; // The longest contiguous run, i.e. up to the end of the ring
+  void regions( std::vector<std::string_view>& out ) const; // At most two: before and after the wrap point
+  void pop( uint64_t len );
+};
+
+// A queue of owned chunks. Pushed strings are moved in as-is, so pushing never copies any bytes.
+class ChunkQueue
+{
+  std::deque<std::string> chunks_ {};
+  uint64_t front_offset_ = 0; // bytes already popped from chunks_.front()
+  std::string reserved_ {};   // the chunk handed out by reserve(), not yet committed
+  std::string spare_ {};      // the last chunk popped, whose storage reserve() reuses if it is big enough
+
+public:
+  void push( std::string data );
+  std::span<char> reserve( uint64_t len ); // A chunk of exactly `len` bytes, allocated only if spare_ is too small
+  void commit( uint64_t len );
+  std::string_view peek() const; // The rest of the front chunk
+  void regions( std::vector<std::string_view>& out ) const; // One per chunk
+  void pop( uint64_t len );
+};
+
+// A ring whose pages are mapped twice, back to back, so the bytes after the wrap point also appear
+// right after the end of the ring. Every stored byte is therefore readable (and every free byte writable)
+// as one contiguous run. The ring's size is the capacity rounded up to whole pages. Linux only (memfd).
+class MirroredRing
+{
+  FileDescriptor memfd_;
+  uint64_t ring_size_; // bytes in one copy of the mapping (a multiple of the page size)
+  char* base_ {};      // start of the first of the two mappings
+  uint64_t head_ = 0;  // offset from base_ of the next byte to be popped (always < ring_size_)
+  uint64_t size_ = 0;  // number of bytes currently stored
+
+  // Staging pipe for splice_from(), created on first use: splice() needs a pipe on one side.
+  std::optional<FileDescriptor> pipe_read_ {};
+  std::optional<FileDescriptor> pipe_write_ {};
+
+public:
+  explicit MirroredRing( uint64_t capacity );
+  ~MirroredRing();
+
+  // Copies get their own mapping holding the same bytes.
+  MirroredRing( const MirroredRing& other );
+  MirroredRing& operator=( const MirroredRing& other );
+  MirroredRing( MirroredRing&& other ) noexcept;
+  MirroredRing& operator=( MirroredRing&& other ) noexcept;
+
+  void push( std::string data );
+  std::span<char> reserve( uint64_t len ); // Never split by the wrap point
+  void commit( uint64_t len );
+  std::string_view peek() const; // Every stored byte
+  void regions( std::vector<std::string_view>& out ) const;
+  void pop( uint64_t len );
+
+  // Because the ring is a memfd, bytes can move between it and other descriptors inside the kernel.
+  // splice_from() places up to `len` bytes from `source` after the stored bytes, to be commit()ed by the caller;
+  // send_to() sends stored bytes from the front to `sink`, to be pop()ped by the caller. Both return a byte count.
+  uint64_t splice_from( FileDescriptor& source, uint64_t len );
+  uint64_t send_to( FileDescriptor& sink );
+};
+
+// A list of fixed-size chunks borrowed from a shared BufferPool. Chunks are borrowed as bytes arrive
+// and given back as soon as they are fully popped, so an empty stream holds no memory at all.
+class PooledBuffer
+{
+  std::shared_ptr<BufferPool> pool_;
+  std::deque<char*> chunks_ {};
+  uint64_t head_ = 0; // offset in chunks_.front() of the next byte to be popped
+  uint64_t size_ = 0; // number of bytes currently stored
+
+  void append( std::string_view data );
+  void give_back_unused(); // Return the chunks beyond the last stored byte to the pool
+
+public:
+  explicit PooledBuffer( std::shared_ptr<BufferPool> pool );
+  ~PooledBuffer();
+
+  // Copies borrow their own chunks from the same pool.
+  PooledBuffer( const PooledBuffer& other );
+  PooledBuffer& operator=( const PooledBuffer& other );
+  PooledBuffer( PooledBuffer&& other ) noexcept;
+  PooledBuffer& operator=( PooledBuffer&& other ) noexcept;
+
+  void push( std::string data );
+  std::span<char> reserve( uint64_t len ); // Stops at the end of a chunk
+  void commit( uint64_t len );
+  std::string_view peek() const; // The rest of the front chunk
+  void regions( std::vector<std::string_view>& out ) const;
+  void pop( uint64_t len );
+};
+
+// A ring over caller-provided storage whose size is a power of two, so positions wrap with a mask.
+// StaticByteStream points it at its inline array. A copy gets its own heap buffer, while assignment
+// copies the bytes into the existing storage (so assigning between StaticByteStreams never allocates).
+class FixedRing
+{
+  std::unique_ptr<char[]> owned_ {}; // storage of a copy; empty when the storage is provided
+  char* data_;
+  uint64_t mask_;     // storage size - 1
+  uint64_t head_ = 0; // index in data_ of the next byte to be popped
+  uint64_t size_ = 0; // number of bytes currently stored
+
+public:
+  explicit FixedRing( std::span<char> storage ); // storage.size() must be a power of two
+  ~FixedRing() = default;
+
+  // The storage may not belong to the ring, so moves copy as well.
+  FixedRing( const FixedRing& other );
+  FixedRing& operator=( const FixedRing& other );
+
+  void push( std::string data );
+  std::span<char> reserve( uint64_t len ); // Stops at the end of the ring
+  void commit( uint64_t len );
+  std::string_view peek() const; // The longest contiguous run, i.e. up to the end of the ring
+  void regions( std::vector<std::string_view>& out ) const;
+  void pop( uint64_t len );
+};
+
+using ByteStreamStorage = std::variant<RingBuffer, ChunkQueue, MirroredRing, PooledBuffer, FixedRing>;
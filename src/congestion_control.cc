@@ -0,0 +1,116 @@
+#include "congestion_control.hh"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+// RFC 6928: min( 10 * SMSS, max( 2 * SMSS, 14600 ) )
+LossBasedWindow::LossBasedWindow( uint64_t smss )
+  : smss_( smss ), cwnd_( min( 10 * smss, max<uint64_t>( 2 * smss, 14600 ) ) )
+{}
+
+void LossBasedWindow::on_partial_ack( uint64_t bytes_acked )
+{
+  // Deflate by the data acknowledged, then add back a segment if it was at least one, so that about ssthresh
+  // sequence numbers are in flight when recovery ends.
+  cwnd_ -= min( cwnd_, bytes_acked );
+  if ( bytes_acked >= smss_ ) {
+    cwnd_ += smss_;
+  }
+  cwnd_ = max( cwnd_, smss_ );
+}
+
+void LossBasedWindow::on_recovery_exit( uint64_t bytes_outstanding )
+{
+  // Deflate the window, without allowing a burst of more than one segment.
+  cwnd_ = min( ssthresh_, max( bytes_outstanding, smss_ ) + smss_ );
+}
+
+void NewReno::on_ack( uint64_t bytes_acked, uint64_t /* now */ )
+{
+  if ( cwnd_ < ssthresh_ ) {
+    cwnd_ += min( bytes_acked, smss_ );
+    return;
+  }
+
+  // Congestion avoidance: one SMSS per window of acknowledged data.
+  bytes_acked_ += bytes_acked;
+  if ( bytes_acked_ >= cwnd_ ) {
+    bytes_acked_ -= cwnd_;
+    cwnd_ += smss_;
+  }
+}
+
+void NewReno::on_timeout( uint64_t bytes_outstanding )
+{
+  ssthresh_ = max( bytes_outstanding / 2, 2 * smss_ );
+  cwnd_ = smss_;
+  bytes_acked_ = 0;
+}
+
+void NewReno::on_fast_retransmit( uint64_t bytes_outstanding, uint64_t /* now */ )
+{
+  ssthresh_ = max( bytes_outstanding / 2, 2 * smss_ );
+  // The three duplicate acks mean three segments have left the network.
+  cwnd_ = ssthresh_ + 3 * smss_;
+  bytes_acked_ = 0;
+}
+
+void Cubic::on_send( uint64_t bytes_outstanding, uint64_t now )
+{
+  // After an idle period, shift the epoch so the cubic resumes where it left off rather than jumping ahead.
+  if ( bytes_outstanding == 0 and epoch_start_.has_value() and now > last_ack_ ) {
+    *epoch_start_ += now - last_ack_;
+    last_ack_ = now;
+  }
+}
+
+void Cubic::on_ack( uint64_t bytes_acked, uint64_t now )
+{
+  last_ack_ = now;
+  if ( cwnd_ < ssthresh_ ) {
+    cwnd_ += min( bytes_acked, smss_ );
+    return;
+  }
+
+  const double segment = static_cast<double>( smss_ );
+  const double cwnd = static_cast<double>( cwnd_ ) / segment;
+  if ( not epoch_start_.has_value() ) {
+    epoch_start_ = now;
+    w_est_ = cwnd;
+    k_ = w_max_ > cwnd ? cbrt( ( w_max_ - cwnd ) / C ) : 0;
+    w_max_ = max( w_max_, cwnd );
+  }
+
+  // Reno-friendly estimate: grows by 3(1 - beta)/(1 + beta) segments per window acknowledged.
+  w_est_ += 3 * ( 1 - BETA ) / ( 1 + BETA ) * static_cast<double>( bytes_acked ) / segment / cwnd;
+
+  const double t = static_cast<double>( now - *epoch_start_ ) / 1000;
+  const double target = clamp( w_max_ + C * pow( t - k_, 3 ), cwnd, 1.5 * cwnd );
+  double next = cwnd + ( target - cwnd ) / cwnd * static_cast<double>( bytes_acked ) / segment;
+  next = max( next, w_est_ );
+  cwnd_ = max( cwnd_, static_cast<uint64_t>( next * segment ) );
+}
+
+void Cubic::on_timeout( uint64_t /* bytes_outstanding */ )
+{
+  reduce();
+  cwnd_ = smss_;
+}
+
+void Cubic::on_fast_retransmit( uint64_t /* bytes_outstanding */, uint64_t now )
+{
+  reduce();
+  last_ack_ = now;
+  cwnd_ = ssthresh_ + 3 * smss_;
+}
+
+void Cubic::reduce()
+{
+  // Fast convergence: if the window shrank since the last loss, leave more room for competing flows.
+  const double cwnd = static_cast<double>( cwnd_ ) / static_cast<double>( smss_ );
+  w_max_ = cwnd < w_max_ ? cwnd * ( 1 + BETA ) / 2 : cwnd;
+  ssthresh_ = max( static_cast<uint64_t>( static_cast<double>( cwnd_ ) * BETA ), 2 * smss_ );
+  epoch_start_.reset();
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <variant>
+
+/*
+ * Congestion-control algorithms for a TCPSender.
+ *
+ * The TCPSender never has more than min( cwnd, receive window ) sequence numbers in flight, and tells the
+ * algorithm about the events that move its congestion window. Every algorithm offers the same small interface,
+ * in sequence numbers and milliseconds of tick() time:
+ *
+ *   on_send( bytes_outstanding, now )            -- a new segment is about to be sent, with `bytes_outstanding`
+ *                                                   already sent and not yet acknowledged
+ *   on_ack( bytes_acked, now )                   -- outside fast recovery, an ack acknowledged `bytes_acked` new
+ *                                                   sequence numbers
+ *   on_timeout( bytes_outstanding )              -- the retransmission timer expired with `bytes_outstanding`
+ *                                                   unacked
+ *   on_fast_retransmit( bytes_outstanding, now ) -- a third duplicate ack: a segment was lost, and the sender
+ *                                                   enters fast recovery
+ *   on_duplicate_ack()                           -- a further duplicate ack during fast recovery
+ *   on_partial_ack( bytes_acked )                -- an ack during fast recovery that leaves data from before the
+ *                                                   loss unacknowledged
+ *   on_recovery_exit( bytes_outstanding )        -- an ack ended fast recovery
+ *   cwnd()                                       -- the congestion window
+ *   ssthresh()                                   -- the slow-start threshold
+ */
+
+// No congestion control: the receive window alone limits the sender.
+class UnlimitedWindow
+{
+public:
+  void on_send( uint64_t /* bytes_outstanding */, uint64_t /* now */ ) {}
+  void on_ack( uint64_t /* bytes_acked */, uint64_t /* now */ ) {}
+  void on_timeout( uint64_t /* bytes_outstanding */ ) {}
+  void on_fast_retransmit( uint64_t /* bytes_outstanding */, uint64_t /* now */ ) {}
+  void on_duplicate_ack() {}
+  void on_partial_ack( uint64_t /* bytes_acked */ ) {}
+  void on_recovery_exit( uint64_t /* bytes_outstanding */ ) {}
+  uint64_t cwnd() const { return std::numeric_limits<uint64_t>::max(); }
+  uint64_t ssthresh() const { return std::numeric_limits<uint64_t>::max(); }
+};
+
+// The window state of the loss-based algorithms below, starting from an RFC 6928 initial window, and the
+// RFC 6582 (NewReno) fast-recovery adjustments they share: each duplicate ack inflates cwnd by a segment, as one
+// more segment has left the network, and a partial ack deflates it by the data it acknowledged.
+class LossBasedWindow
+{
+protected:
+  uint64_t smss_;
+  uint64_t cwnd_;
+  uint64_t ssthresh_ = std::numeric_limits<uint64_t>::max();
+
+  explicit LossBasedWindow( uint64_t smss );
+
+public:
+  void on_duplicate_ack() { cwnd_ += smss_; }
+  void on_partial_ack( uint64_t bytes_acked );
+  void on_recovery_exit( uint64_t bytes_outstanding );
+  uint64_t cwnd() const { return cwnd_; }
+  uint64_t ssthresh() const { return ssthresh_; }
+};
+
+// RFC 5681 slow start and congestion avoidance (with byte counting), halving the data in flight on a loss.
+class NewReno : public LossBasedWindow
+{
+  uint64_t bytes_acked_ = 0; // acked in congestion avoidance since cwnd last grew
+
+public:
+  explicit NewReno( uint64_t smss ) : LossBasedWindow( smss ) {}
+
+  void on_send( uint64_t /* bytes_outstanding */, uint64_t /* now */ ) {}
+  void on_ack( uint64_t bytes_acked, uint64_t now );
+  void on_timeout( uint64_t bytes_outstanding );
+  void on_fast_retransmit( uint64_t bytes_outstanding, uint64_t now );
+};
+
+// RFC 9438 CUBIC: after a loss, cwnd follows a cubic function of the time since the loss, centred on the window
+// where the loss happened, but never grows more slowly than Reno would (the "Reno-friendly" region).
+class Cubic : public LossBasedWindow
+{
+  static constexpr double C = 0.4;
+  static constexpr double BETA = 0.7;
+
+  double w_max_ = 0;                       // cwnd (in segments) just before the last reduction
+  double k_ = 0;                           // seconds the cubic takes to climb back to w_max_
+  double w_est_ = 0;                       // the window Reno would have (in segments)
+  std::optional<uint64_t> epoch_start_ {}; // when the current congestion-avoidance epoch began
+  uint64_t last_ack_ = 0;
+
+public:
+  explicit Cubic( uint64_t smss ) : LossBasedWindow( smss ) {}
+
+  void on_send( uint64_t bytes_outstanding, uint64_t now );
+  void on_ack( uint64_t bytes_acked, uint64_t now );
+  void on_timeout( uint64_t bytes_outstanding );
+  void on_fast_retransmit( uint64_t bytes_outstanding, uint64_t now );
+
+private:
+  void reduce(); // Multiplicative decrease: remember w_max_, set ssthresh_ and end the epoch
+};
+
+using CongestionControl = std::variant<UnlimitedWindow, NewReno, Cubic>;
@@ -1,146 +1,104 @@
 #include "reassembler.hh"
 
+#include <algorithm>
+
 using namespace std;
 
-void Reassembler::insert( uint64_t first_index, string data, bool is_last_substring, Writer& output )
+Reassembler Reassembler::windowed( shared_ptr<ReassemblyBudget> budget )
 {
-  const uint64_t end_index = first_index + data.size();
-  if ( end_index < next_seq_num_ ) {
-    return;
-  }
-  if ( is_last_substring ) {
-    last_substring_end_index_ = end_index;
-  }
-  if ( first_index > next_seq_num_ ) {
-    auto [success, hint] = fit_string( data, first_index );
-    if ( !success ) {
-      return;
-    }
-    if ( !fit_space( data, output ) ) {
-      return;
-    }
-    bytes_pending_ += data.size();
-    substrings_.emplace_hint( hint, first_index, std::move( data ) );
-
-  } else {
-    const auto max_space = min( space( output ), end_index - next_seq_num_ );
-
-    data.erase( 0, next_seq_num_ - first_index ).erase( max_space );
-    output.push( std::move( data ) );
-    next_seq_num_ += max_space;
-
-    scan_storage( output );
-  }
-  if ( output.bytes_pushed() == last_substring_end_index_ ) {
-    output.close();
-  }
+  return { ReassemblyWindow {}, std::move( budget ) };
 }
 
-bool Reassembler::fit_space( std::string& data, const Writer& output )
+void Reassembler::insert( uint64_t first_index, string data, bool is_last_substring, Writer& output )
 {
-  if ( data.size() > space( output ) ) {
-    return false;
-  }
-  if ( data.size() == space( output ) ) {
-    data.pop_back();
+  if ( first_index == next_seq_num_ && data.size() <= output.available_capacity() ) {
+    // The common in-order case: hand the whole string over, which some Writers keep without copying.
+    next_seq_num_ += data.size();
+    output.push( std::move( data ) );
+    if ( is_last_substring ) {
+      last_substring_end_index_ = next_seq_num_;
+    }
+    push_ready( output );
+    return;
   }
-  return true;
-}
 
-uint64_t Reassembler::bytes_pending() const
-{
-  return bytes_pending_;
+  const uint64_t length = data.size();
+  insert( first_index, BufferSlice { Buffer { std::move( data ) }, 0, length }, is_last_substring, output );
 }
 
-uint64_t Reassembler::space( const Writer& writer ) const
+void Reassembler::insert( uint64_t first_index, BufferSlice data, bool is_last_substring, Writer& output )
 {
-  return writer.available_capacity() - bytes_pending_;
-}
-
-std::pair<bool, MapIt_t> Reassembler::fit_string( std::string& data, uint64_t& first_index )
-{
-  if ( substrings_.empty() ) {
-    return { true, substrings_.end() };
+  if ( is_last_substring ) {
+    last_substring_end_index_ = first_index + data.length;
   }
-  auto end_index = first_index + data.size();
 
-  // Case 1: lower_bound - 1
-  auto it = substrings_.lower_bound( first_index );
-  if ( it != substrings_.begin() ) {
-    it--;
-    // if overlapping
-    const auto end_index_it = end_index_of( it );
-    if ( end_index_it > first_index ) {
-      if ( end_index_it >= end_index ) {
-        // this string is already contained by the string iterator points to
-        return { false, {} };
-      }
-      // cut off the overlapping part
-      data.erase( 0, end_index_it - first_index );
-      first_index = end_index_it;
+  // Only bytes in [next_seq_num_, next_seq_num_ + available capacity) could ever be written; drop the rest.
+  const uint64_t begin_index = max( first_index, next_seq_num_ );
+  const uint64_t end_index = min( first_index + data.length, next_seq_num_ + output.available_capacity() );
+  if ( begin_index < end_index ) {
+    data.offset += begin_index - first_index;
+    data.length = end_index - begin_index;
+    if ( begin_index == next_seq_num_ ) {
+      write( output, data.view() );
+      next_seq_num_ = end_index;
+    } else {
+      std::visit( [&]( auto& storage ) { storage.store( begin_index, std::move( data ) ); }, storage_ );
     }
-    // whether the first_index is updated or not,
-    // previous string is still the lower bound of new string
-    it++;
-  }
-  // the new string is the last string in reassembler storage ( no overlapping )
-  if ( it == substrings_.end() ) {
-    return { true, substrings_.end() };
   }
+  push_ready( output );
+}
 
-  // Case 2: lower_bound ( equal )
-  if ( it->first == first_index ) {
-    end_index = data.size() + first_index;
-    if ( end_index_of( it ) >= end_index ) {
-      // this string is already contained by the string iterator points to
-      return { false, {} };
-    }
-    // erase the string iterator points to and get next string
-    it = erase_substring_by( it );
-    if ( it == substrings_.end() ) {
-      return { true, substrings_.end() };
-    }
-  }
+void Reassembler::insert_batch( span<Segment> segments, Writer& output )
+{
+  ranges::sort( segments, {}, &Segment::first_index );
 
-  // Case 3: upper bound
-  end_index = data.size() + first_index;
-  while ( it->first < end_index ) {
-    if ( end_index_of( it ) >= end_index ) {
-      end_index = it->first;
-      data.erase( end_index - first_index );
-      break;
+  // `covered` is the end of the bytes written or stored so far; later segments only contribute what lies past it.
+  const uint64_t window_end = next_seq_num_ + output.available_capacity();
+  uint64_t covered = next_seq_num_;
+  for ( auto& [first_index, data, is_last_substring] : segments ) {
+    if ( is_last_substring ) {
+      last_substring_end_index_ = first_index + data.length;
     }
-    it = erase_substring_by( it );
-    if ( it == substrings_.end() ) {
-      return { true, substrings_.end() };
+    const uint64_t begin_index = max( first_index, covered );
+    const uint64_t end_index = min( first_index + data.length, window_end );
+    if ( begin_index >= end_index ) {
+      continue;
+    }
+    data.offset += begin_index - first_index;
+    data.length = end_index - begin_index;
+    if ( begin_index == next_seq_num_ ) {
+      write( output, data.view() );
+      next_seq_num_ = end_index;
+    } else {
+      std::visit( [&]( auto& storage ) { storage.store( begin_index, std::move( data ) ); }, storage_ );
     }
+    covered = end_index;
   }
-  return { true, it };
+  push_ready( output );
 }
 
-uint64_t Reassembler::end_index_of( MapIt_t it )
+uint64_t Reassembler::bytes_pending() const
 {
-  return it->first + it->second.size();
+  return std::visit( []( const auto& storage ) { return storage.bytes_pending(); }, storage_ );
 }
 
-void Reassembler::scan_storage( Writer& writer )
+size_t Reassembler::held_intervals( span<pair<uint64_t, uint64_t>> out ) const
 {
-  for ( auto it = substrings_.begin(); it != substrings_.end() && it->first <= next_seq_num_; ) {
-    auto end_index = end_index_of( it );
-    if ( end_index > next_seq_num_ ) {
-      writer.push( std::move( it->second.erase( 0, next_seq_num_ - it->first ) ) );
-      next_seq_num_ = end_index;
-      // do not use erase_substring_by(), it->second is moved and thus its size is changed
-      bytes_pending_ -= end_index - it->first;
-      it = substrings_.erase( it );
-    } else {
-      it = erase_substring_by( it );
-    }
-  }
+  return std::visit( [out]( const auto& storage ) { return storage.intervals( out ); }, storage_ );
 }
 
-MapIt_t Reassembler::erase_substring_by( MapIt_t it )
+void Reassembler::push_ready( Writer& output )
 {
-  bytes_pending_ -= it->second.size();
-  return substrings_.erase( it );
-}
\ No newline at end of file
+  std::visit( [&]( auto& storage ) { storage.push_ready( next_seq_num_, output ); }, storage_ );
+
+  const uint64_t excess = budget_.charge( bytes_pending() );
+  if ( excess > 0 ) {
+    const auto pruned = std::visit( [excess]( auto& storage ) { return storage.prune( excess ); }, storage_ );
+    budget_.record_pruned( pruned.bytes, pruned.runs );
+    budget_.charge( bytes_pending() );
+  }
+
+  if ( output.bytes_pushed() == last_substring_end_index_ ) {
+    output.close();
+  }
+}
@@ -1,23 +1,47 @@
 #pragma once
 
+#include "buffer.hh"
 #include "byte_stream.hh"
+#include "reassembler_storage.hh"
+#include "reassembly_budget.hh"
 
 #include <climits>
-#include <map>
+#include <cstddef>
+#include <memory>
+#include <span>
 #include <string>
-#include <unordered_map>
-
-using MapIt_t = std::map<uint64_t, std::string>::iterator;
+#include <utility>
 
 class Reassembler
 {
 private:
-  std::map<uint64_t, std::string> substrings_ {};
+  ReassemblerStorage storage_ {};
+  ReassemblyBudget::Account budget_ {};
   uint64_t next_seq_num_ = 0;
-  uint64_t bytes_pending_ = 0;
   uint64_t last_substring_end_index_ = UINT64_MAX;
 
+  Reassembler( ReassemblerStorage storage, std::shared_ptr<ReassemblyBudget> budget )
+    : storage_( std::move( storage ) ), budget_( std::move( budget ) )
+  {}
+
 public:
+  // One substring of a batch for insert_batch()
+  struct Segment
+  {
+    uint64_t first_index;
+    BufferSlice data;
+    bool is_last_substring = false;
+  };
+
+  Reassembler() = default;
+
+  // A Reassembler whose pending bytes count against a budget shared with other Reassemblers
+  explicit Reassembler( std::shared_ptr<ReassemblyBudget> budget ) : budget_( std::move( budget ) ) {}
+
+  // A Reassembler that keeps out-of-order bytes in one window-sized ring with a presence bitmap,
+  // instead of a sorted list of held intervals (see ReassemblyWindow and IntervalStore).
+  static Reassembler windowed( std::shared_ptr<ReassemblyBudget> budget = {} );
+
   /*
    * Insert a new substring to be reassembled into a ByteStream.
    *   `first_index`: the index of the first byte of the substring
@@ -40,18 +64,23 @@ public:
    */
   void insert( uint64_t first_index, std::string data, bool is_last_substring, Writer& output );
 
-  // How many bytes are stored in the Reassembler itself?
-  uint64_t bytes_pending() const;
-
-private:
-  uint64_t space( const Writer& writer ) const;
+  // The same, for a slice of a received Buffer (`first_index` is the index of its first byte).
+  // Pending bytes are kept as slices of the Buffer, so each byte is copied once, into the Writer.
+  void insert( uint64_t first_index, BufferSlice data, bool is_last_substring, Writer& output );
 
-  std::pair<bool, MapIt_t> fit_string( std::string& data, uint64_t& first_index );
-  bool fit_space( std::string& data, const Writer& output );
+  // Insert a burst of substrings at once (same result as inserting them one by one, in any order).
+  // The batch is sorted in place and walked once: each segment is trimmed to what earlier ones didn't cover, then
+  // written if it starts at the next index or stored otherwise (one write() or store() per segment, unmerged).
+  void insert_batch( std::span<Segment> segments, Writer& output );
 
-  MapIt_t erase_substring_by( MapIt_t it );
+  // How many bytes are stored in the Reassembler itself?
+  uint64_t bytes_pending() const;
 
-  void scan_storage( Writer& writer );
+  // Fill `out` with the first held ranges of stream indices [begin, end) beyond the next index, lowest first
+  // (like TCP SACK blocks), and return how many were written. Doesn't allocate.
+  size_t held_intervals( std::span<std::pair<uint64_t, uint64_t>> out ) const;
 
-  static uint64_t end_index_of( MapIt_t it );
+private:
+  // Push newly contiguous bytes, keep within the budget, and close the stream after the last byte
+  void push_ready( Writer& output );
 };
@@ -0,0 +1,344 @@
+#include "reassembler_storage.hh"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <iterator>
+
+using namespace std;
+
+void IntervalStore::store( uint64_t first_index, BufferSlice data )
+{
+  const uint64_t end_index = first_index + data.length;
+  const auto part = [&]( uint64_t from, uint64_t to ) {
+    return BufferSlice { data.buffer, data.offset + ( from - first_index ), to - from };
+  };
+  const auto link_after = [&]( uint32_t tail, uint32_t node ) {
+    nodes_[tail].next = node;
+    nodes_[node].prev = tail;
+  };
+
+  // `pos` is the first held interval that overlaps or touches [first_index, end_index), if any.
+  const Position pos = find( first_index );
+  if ( is_end( pos ) or at( pos ).begin > end_index ) {
+    bytes_pending_ += data.length;
+    const uint32_t node = new_node( std::move( data ) );
+    insert( pos, { first_index, end_index, node, node } );
+    return;
+  }
+
+  // Extend that interval in place, filling the gaps up to the later intervals it reaches from `data`, and
+  // splicing their slices onto its own.
+  uint64_t held = at( pos ).end - at( pos ).begin;
+  if ( first_index < at( pos ).begin ) {
+    const uint32_t node = new_node( part( first_index, at( pos ).begin ) );
+    link_after( node, at( pos ).head );
+    at( pos ).head = node;
+    at( pos ).begin = first_index;
+  }
+  for ( Position later = next( pos ); not is_end( later ) and at( later ).begin <= end_index;
+        later = next( pos ) ) {
+    const Interval absorbed = at( later );
+    erase( later );
+    if ( absorbed.begin > at( pos ).end ) {
+      const uint32_t node = new_node( part( at( pos ).end, absorbed.begin ) );
+      link_after( at( pos ).tail, node );
+      at( pos ).tail = node;
+    }
+    link_after( at( pos ).tail, absorbed.head );
+    at( pos ).tail = absorbed.tail;
+    at( pos ).end = absorbed.end;
+    held += absorbed.end - absorbed.begin;
+  }
+  if ( end_index > at( pos ).end ) {
+    const uint32_t node = new_node( part( at( pos ).end, end_index ) );
+    link_after( at( pos ).tail, node );
+    at( pos ).tail = node;
+    at( pos ).end = end_index;
+  }
+
+  bytes_pending_ += at( pos ).end - at( pos ).begin - held;
+}
+
+void IntervalStore::push_ready( uint64_t& next_index, Writer& output )
+{
+  while ( not leaves_.empty() ) {
+    auto& leaf = leaves_.front();
+    size_t done = 0;
+    for ( ; done < leaf.size() && leaf[done].begin <= next_index; done++ ) {
+      const Interval& interval = leaf[done];
+      bytes_pending_ -= interval.end - interval.begin;
+      uint64_t slice_begin = interval.begin;
+      for ( uint32_t node = interval.head; node != NIL; ) {
+        const BufferSlice& slice = nodes_[node].slice;
+        const uint64_t slice_end = slice_begin + slice.length;
+        if ( slice_end > next_index ) {
+          write( output, slice.view().substr( max( next_index, slice_begin ) - slice_begin ) );
+        }
+        slice_begin = slice_end;
+        const uint32_t following = nodes_[node].next;
+        free_node( node );
+        node = following;
+      }
+      next_index = max( next_index, interval.end );
+    }
+    leaf.erase( leaf.begin(), leaf.begin() + static_cast<ptrdiff_t>( done ) );
+    if ( not leaf.empty() ) {
+      return;
+    }
+    leaves_.erase( leaves_.begin() );
+  }
+}
+
+size_t IntervalStore::intervals( span<pair<uint64_t, uint64_t>> out ) const
+{
+  size_t count = 0;
+  for ( const auto& leaf : leaves_ ) {
+    for ( const auto& interval : leaf ) {
+      if ( count == out.size() ) {
+        return count;
+      }
+      out[count++] = { interval.begin, interval.end };
+    }
+  }
+  return count;
+}
+
+PrunedBytes IntervalStore::prune( uint64_t len )
+{
+  PrunedBytes pruned { 0, 0 };
+  while ( pruned.bytes < len && !leaves_.empty() ) {
+    // Cut the last run back from its end, shortening its last slice or dropping it, until enough is gone.
+    Interval& last = leaves_.back().back();
+    pruned.runs++;
+    while ( pruned.bytes < len && last.tail != NIL ) {
+      BufferSlice& slice = nodes_[last.tail].slice;
+      const uint64_t count = min( slice.length, len - pruned.bytes );
+      slice.length -= count;
+      last.end -= count;
+      pruned.bytes += count;
+      if ( slice.length == 0 ) {
+        const uint32_t node = last.tail;
+        last.tail = nodes_[node].prev;
+        free_node( node );
+        if ( last.tail != NIL ) {
+          nodes_[last.tail].next = NIL;
+        }
+      }
+    }
+    if ( last.tail == NIL ) {
+      erase( { leaves_.size() - 1, leaves_.back().size() - 1 } );
+    }
+  }
+  bytes_pending_ -= pruned.bytes;
+  return pruned;
+}
+
+IntervalStore::Position IntervalStore::find( uint64_t first_index ) const
+{
+  const auto leaf
+    = ranges::partition_point( leaves_, [&]( const auto& l ) { return l.back().end < first_index; } );
+  if ( leaf == leaves_.end() ) {
+    return { leaves_.size(), 0 };
+  }
+  const auto it = ranges::partition_point( *leaf, [&]( const Interval& iv ) { return iv.end < first_index; } );
+  return { static_cast<size_t>( leaf - leaves_.begin() ), static_cast<size_t>( it - leaf->begin() ) };
+}
+
+IntervalStore::Position IntervalStore::next( Position pos ) const
+{
+  if ( pos.index + 1 < leaves_[pos.leaf].size() ) {
+    return { pos.leaf, pos.index + 1 };
+  }
+  return { pos.leaf + 1, 0 };
+}
+
+void IntervalStore::insert( Position pos, const Interval& interval )
+{
+  if ( leaves_.empty() ) {
+    leaves_.push_back( { interval } );
+    return;
+  }
+  if ( is_end( pos ) ) {
+    pos = { leaves_.size() - 1, leaves_.back().size() };
+  }
+  auto& leaf = leaves_[pos.leaf];
+  leaf.insert( leaf.begin() + static_cast<ptrdiff_t>( pos.index ), interval );
+  if ( leaf.size() > MAX_LEAF_SIZE ) {
+    // Split a full leaf in two.
+    const auto middle = leaf.begin() + static_cast<ptrdiff_t>( leaf.size() / 2 );
+    vector<Interval> upper( middle, leaf.end() );
+    leaf.erase( middle, leaf.end() );
+    leaves_.insert( leaves_.begin() + static_cast<ptrdiff_t>( pos.leaf + 1 ), std::move( upper ) );
+  }
+}
+
+void IntervalStore::erase( Position pos )
+{
+  auto& leaf = leaves_[pos.leaf];
+  leaf.erase( leaf.begin() + static_cast<ptrdiff_t>( pos.index ) );
+  if ( leaf.empty() ) {
+    leaves_.erase( leaves_.begin() + static_cast<ptrdiff_t>( pos.leaf ) );
+  }
+}
+
+uint32_t IntervalStore::new_node( BufferSlice slice )
+{
+  uint32_t node = free_nodes_;
+  if ( node == NIL ) {
+    node = static_cast<uint32_t>( nodes_.size() );
+    nodes_.push_back( { std::move( slice ), NIL, NIL } );
+  } else {
+    free_nodes_ = nodes_[node].next;
+    nodes_[node] = { std::move( slice ), NIL, NIL };
+  }
+  return node;
+}
+
+void IntervalStore::free_node( uint32_t node )
+{
+  nodes_[node].slice = { empty_, 0, 0 };
+  nodes_[node].next = free_nodes_;
+  free_nodes_ = node;
+}
+
+void ReassemblyWindow::store( uint64_t first_index, const BufferSlice& slice )
+{
+  const string_view data = slice.view();
+  const uint64_t needed = first_index + data.size() - base_;
+  if ( needed > buffer_.size() ) {
+    grow( bit_ceil( max<uint64_t>( needed, 64 ) ) );
+  }
+
+  // The substring may wrap around the end of the ring: copy up to the end, then the rest from the start.
+  const uint64_t mask = buffer_.size() - 1;
+  const uint64_t slot = first_index & mask;
+  const uint64_t first_part = min<uint64_t>( data.size(), buffer_.size() - slot );
+  memcpy( buffer_.data() + slot, data.data(), first_part );
+  memcpy( buffer_.data(), data.data() + first_part, data.size() - first_part );
+
+  bytes_pending_ += mark( first_index, data.size(), true );
+}
+
+void ReassemblyWindow::push_ready( uint64_t& next_index, Writer& output )
+{
+  if ( next_index > base_ ) {
+    bytes_pending_ -= mark( base_, min<uint64_t>( next_index - base_, buffer_.size() ), false );
+    base_ = next_index;
+  }
+
+  const uint64_t run = run_length( base_, true, buffer_.size() );
+  if ( run == 0 ) {
+    return;
+  }
+  // The run may wrap around the end of the ring: push up to the end, then the rest from the start.
+  const uint64_t slot = base_ & ( buffer_.size() - 1 );
+  const uint64_t first_part = min<uint64_t>( run, buffer_.size() - slot );
+  write( output, { buffer_.data() + slot, first_part } );
+  write( output, { buffer_.data(), run - first_part } );
+
+  bytes_pending_ -= mark( base_, run, false );
+  base_ += run;
+  next_index = base_;
+}
+
+size_t ReassemblyWindow::intervals( span<pair<uint64_t, uint64_t>> out ) const
+{
+  const uint64_t window_end = base_ + buffer_.size();
+  size_t count = 0;
+  for ( uint64_t index = base_; count < out.size() && index < window_end; ) {
+    index += run_length( index, false, window_end - index );
+    if ( index == window_end ) {
+      break;
+    }
+    const uint64_t run = run_length( index, true, window_end - index );
+    out[count++] = { index, index + run };
+    index += run;
+  }
+  return count;
+}
+
+PrunedBytes ReassemblyWindow::prune( uint64_t len )
+{
+  PrunedBytes pruned { 0, 0 };
+  const uint64_t window_end = base_ + buffer_.size();
+  while ( pruned.bytes < len && bytes_pending_ > 0 ) {
+    // Find the last held run, then drop as much of its tail as is still needed.
+    pair<uint64_t, uint64_t> last {};
+    for ( uint64_t index = base_; index < window_end; ) {
+      index += run_length( index, false, window_end - index );
+      if ( index == window_end ) {
+        break;
+      }
+      const uint64_t run = run_length( index, true, window_end - index );
+      last = { index, index + run };
+      index += run;
+    }
+    const uint64_t count = min( last.second - last.first, len - pruned.bytes );
+    bytes_pending_ -= mark( last.second - count, count, false );
+    pruned.bytes += count;
+    pruned.runs++;
+  }
+  return pruned;
+}
+
+void ReassemblyWindow::grow( uint64_t size )
+{
+  ReassemblyWindow bigger;
+  bigger.buffer_.resize( size );
+  bigger.present_.resize( size / 64 );
+  bigger.base_ = base_;
+  bigger.bytes_pending_ = bytes_pending_;
+
+  const uint64_t old_mask = buffer_.size() - 1;
+  const uint64_t new_mask = size - 1;
+  for ( uint64_t index = base_; index < base_ + buffer_.size(); index++ ) {
+    const uint64_t old_slot = index & old_mask;
+    if ( ( present_[old_slot / 64] >> ( old_slot % 64 ) ) & 1 ) {
+      const uint64_t new_slot = index & new_mask;
+      bigger.buffer_[new_slot] = buffer_[old_slot];
+      bigger.present_[new_slot / 64] |= uint64_t { 1 } << ( new_slot % 64 );
+    }
+  }
+  *this = std::move( bigger );
+}
+
+uint64_t ReassemblyWindow::mark( uint64_t first_index, uint64_t len, bool present )
+{
+  // The ring is a whole number of words, so a run of bits never straddles the wrap point within a word.
+  const uint64_t mask = buffer_.size() - 1;
+  uint64_t changed = 0;
+  for ( uint64_t slot = first_index & mask; len > 0; ) {
+    const uint64_t offset = slot % 64;
+    const uint64_t count = min( len, 64 - offset );
+    const uint64_t bits = ( count == 64 ? ~uint64_t { 0 } : ( ( uint64_t { 1 } << count ) - 1 ) ) << offset;
+    uint64_t& word = present_[slot / 64];
+    if ( present ) {
+      changed += popcount( bits & ~word );
+      word |= bits;
+    } else {
+      changed += popcount( bits & word );
+      word &= ~bits;
+    }
+    len -= count;
+    slot = ( slot + count ) & mask;
+  }
+  return changed;
+}
+
+uint64_t ReassemblyWindow::run_length( uint64_t first_index, bool present, uint64_t limit ) const
+{
+  const uint64_t mask = buffer_.size() - 1;
+  uint64_t run = 0;
+  for ( uint64_t slot = first_index & mask; run < limit; ) {
+    const uint64_t offset = slot % 64;
+    const uint64_t word = present ? present_[slot / 64] : ~present_[slot / 64];
+    const uint64_t ones = countr_one( word >> offset );
+    run += ones;
+    if ( ones < 64 - offset ) {
+      break;
+    }
+    slot = ( slot + ones ) & mask;
+  }
+  return min( run, limit );
+}
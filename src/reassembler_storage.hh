@@ -0,0 +1,123 @@
+#pragma once
+
+#include "buffer.hh"
+#include "byte_stream.hh"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <variant>
+#include <vector>
+
+/*
+ * Storage engines for the out-of-order bytes held by a Reassembler.
+ *
+ * The Reassembler itself trims every substring to the window it may buffer, i.e. to stream indices in
+ * [next index, next index + available capacity), and pushes substrings that start exactly at the next index
+ * straight to the Writer. An engine only ever sees the rest, and offers the same small interface:
+ *
+ *   store( first_index, slice )       -- remember the bytes of `slice` (first_index > the next index); bytes
+ *                                        already held may be sent again and are kept once
+ *   push_ready( next_index, output )  -- forget bytes below `next_index`, then push the contiguous bytes that
+ *                                        start at `next_index` to `output` and advance `next_index` past them
+ *   bytes_pending()                   -- number of distinct bytes held
+ *   intervals( out )                  -- fill `out` with the first held ranges [begin, end), lowest first,
+ *                                        and return how many were written
+ *   prune( len )                      -- drop held bytes from the highest index down until exactly `len` are
+ *                                        gone (or nothing is held); returns the bytes dropped and the number
+ *                                        of held runs they came from
+ */
+
+struct PrunedBytes
+{
+  uint64_t bytes;
+  uint64_t runs; // maximal runs of contiguous held bytes that lost some (or all) of their tail
+};
+
+// Disjoint held intervals, sorted, in a two-level B-tree: a vector of leaves, each a short sorted vector. A
+// substring that overlaps or touches held intervals is merged into the first of them in place, so there is one
+// entry per run of held bytes; a lookup is two binary searches, and an insert or erase only shifts entries within
+// one leaf (splitting it when it fills). Each run is a doubly linked list of slices of the Buffers they arrived
+// in, kept in a pool shared by all runs, so a run grows at either end and absorbs another in O(1) with no heap
+// allocation of its own. Bytes are not copied until they are pushed.
+class IntervalStore
+{
+  static constexpr uint32_t NIL = UINT32_MAX;
+  static constexpr size_t MAX_LEAF_SIZE = 64;
+
+  struct SliceNode
+  {
+    BufferSlice slice;
+    uint32_t prev;
+    uint32_t next;
+  };
+
+  struct Interval
+  {
+    uint64_t begin;
+    uint64_t end;
+    uint32_t head; // first and last of its slices, in order, covering exactly [begin, end)
+    uint32_t tail;
+  };
+
+  struct Position
+  {
+    size_t leaf;
+    size_t index;
+  };
+
+  std::vector<std::vector<Interval>> leaves_ {}; // none empty
+  std::vector<SliceNode> nodes_ {};
+  uint32_t free_nodes_ = NIL; // free list through SliceNode::next
+  Buffer empty_ {};           // what freed nodes refer to, so they don't keep a Buffer alive
+  uint64_t bytes_pending_ = 0;
+
+public:
+  void store( uint64_t first_index, BufferSlice data );
+  void push_ready( uint64_t& next_index, Writer& output );
+  uint64_t bytes_pending() const { return bytes_pending_; }
+  size_t intervals( std::span<std::pair<uint64_t, uint64_t>> out ) const;
+  PrunedBytes prune( uint64_t len );
+
+private:
+  Position find( uint64_t first_index ) const; // The first interval ending at or after first_index
+  Interval& at( Position pos ) { return leaves_[pos.leaf][pos.index]; }
+  bool is_end( Position pos ) const { return pos.leaf == leaves_.size(); }
+  Position next( Position pos ) const;
+  void insert( Position pos, const Interval& interval );
+  void erase( Position pos );
+
+  uint32_t new_node( BufferSlice slice );
+  void free_node( uint32_t node );
+};
+
+// A ring indexed by stream index, with one presence bit per byte. Storing is a memcpy plus setting bits (so unlike
+// IntervalStore, out-of-order bytes are copied twice: into the ring, then into the Writer);
+// the end of the contiguous prefix is found a 64-bit word at a time. The ring is allocated on first use and
+// doubles (to a power of two) whenever a substring reaches past its end, so it never exceeds twice the window.
+class ReassemblyWindow
+{
+  std::vector<char> buffer_ {};      // size is zero or a power of two >= 64
+  std::vector<uint64_t> present_ {}; // bit i is set iff buffer_[i] holds a byte
+  uint64_t base_ = 0;                // stream index of the first byte in the window
+  uint64_t bytes_pending_ = 0;
+
+public:
+  void store( uint64_t first_index, const BufferSlice& slice );
+  void push_ready( uint64_t& next_index, Writer& output );
+  uint64_t bytes_pending() const { return bytes_pending_; }
+  size_t intervals( std::span<std::pair<uint64_t, uint64_t>> out ) const; // Scans the bitmap
+  PrunedBytes prune( uint64_t len );                                      // Drops exactly `len` bytes if held
+
+private:
+  void grow( uint64_t size );
+  uint64_t mark( uint64_t first_index, uint64_t len, bool present ); // Returns how many bits changed
+
+  // Number of consecutive bytes from first_index on (up to `limit`) that are held, or if !present, missing
+  uint64_t run_length( uint64_t first_index, bool present, uint64_t limit ) const;
+};
+
+using ReassemblerStorage = std::variant<IntervalStore, ReassemblyWindow>;
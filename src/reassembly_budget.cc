@@ -0,0 +1,59 @@
+#include "reassembly_budget.hh"
+
+#include <algorithm>
+#include <utility>
+
+using namespace std;
+
+ReassemblyBudget::Account::Account( const Account& other ) : budget_( other.budget_ )
+{
+  charge( other.charged_ );
+}
+
+ReassemblyBudget::Account::Account( Account&& other ) noexcept
+  : budget_( std::move( other.budget_ ) ), charged_( std::exchange( other.charged_, 0 ) )
+{}
+
+ReassemblyBudget::Account& ReassemblyBudget::Account::operator=( const Account& other )
+{
+  if ( this != &other ) {
+    charge( 0 );
+    budget_ = other.budget_;
+    charge( other.charged_ );
+  }
+  return *this;
+}
+
+ReassemblyBudget::Account& ReassemblyBudget::Account::operator=( Account&& other ) noexcept
+{
+  swap( budget_, other.budget_ );
+  swap( charged_, other.charged_ );
+  return *this;
+}
+
+ReassemblyBudget::Account::~Account()
+{
+  charge( 0 );
+}
+
+uint64_t ReassemblyBudget::Account::charge( uint64_t bytes_pending )
+{
+  if ( !budget_ ) {
+    return 0;
+  }
+  budget_->bytes_in_use_ = budget_->bytes_in_use_ - charged_ + bytes_pending;
+  charged_ = bytes_pending;
+  if ( budget_->bytes_in_use_ > budget_->limit_ ) {
+    return budget_->bytes_in_use_ - budget_->limit_;
+  }
+  budget_->peak_bytes_in_use_ = max( budget_->peak_bytes_in_use_, budget_->bytes_in_use_ );
+  return 0;
+}
+
+void ReassemblyBudget::Account::record_pruned( uint64_t bytes, uint64_t runs )
+{
+  if ( budget_ ) {
+    budget_->pruned_bytes_ += bytes;
+    budget_->pruned_runs_ += runs;
+  }
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+
+/*
+ * A cap on the out-of-order bytes held by all the Reassemblers that share it (e.g. every connection of a server).
+ *
+ * Each Reassembler charges its bytes_pending() to the budget. When an insert takes the total over the limit,
+ * that Reassembler prunes exactly the excess from its own highest-offset pending data (the bytes furthest from
+ * being deliverable, and the cheapest for the peer to resend), like Linux's tcp_prune_ofo_queue(). If the total
+ * was within the limit before the insert, the insert added at least the excess, so every insert leaves it within
+ * the limit again. Nothing prunes a Reassembler's bytes but its own inserts, though: a total taken over the limit
+ * some other way (e.g. by copying a Reassembler) stays over until the Reassemblers holding the bytes insert again.
+ * The budget is not thread-safe.
+ */
+class ReassemblyBudget
+{
+  uint64_t limit_;
+  uint64_t bytes_in_use_ = 0;
+  uint64_t peak_bytes_in_use_ = 0;
+  uint64_t pruned_bytes_ = 0;
+  uint64_t pruned_runs_ = 0;
+
+public:
+  explicit ReassemblyBudget( uint64_t limit ) : limit_( limit ) {}
+
+  uint64_t limit() const { return limit_; }
+  uint64_t bytes_in_use() const { return bytes_in_use_; }           // Pending bytes across all Reassemblers
+  uint64_t peak_bytes_in_use() const { return peak_bytes_in_use_; } // High-water mark, measured after pruning
+  uint64_t pruned_bytes() const { return pruned_bytes_; }           // Pending bytes dropped to stay in budget
+  uint64_t pruned_runs() const { return pruned_runs_; }             // Held runs of contiguous bytes cut into
+
+  // One Reassembler's charge against a (possibly absent) budget, released when the account is destroyed.
+  // Copying an account charges the copy's bytes too, as a copied Reassembler holds its own pending bytes.
+  class Account
+  {
+    std::shared_ptr<ReassemblyBudget> budget_ {};
+    uint64_t charged_ = 0;
+
+  public:
+    Account() = default;
+    explicit Account( std::shared_ptr<ReassemblyBudget> budget ) : budget_( std::move( budget ) ) {}
+    Account( const Account& other );
+    Account( Account&& other ) noexcept;
+    Account& operator=( const Account& other );
+    Account& operator=( Account&& other ) noexcept;
+    ~Account();
+
+    // Charge exactly `bytes_pending`; returns how many bytes must be pruned to get back within the limit.
+    uint64_t charge( uint64_t bytes_pending );
+    void record_pruned( uint64_t bytes, uint64_t runs );
+  };
+};
@@ -0,0 +1,102 @@
+#include "retransmission_ring.hh"
+
+#include <algorithm>
+#include <string>
+#include <string_view>
+#include <utility>
+
+using namespace std;
+
+BufferSlice RetransmissionRing::append( Reader& reader, uint64_t len )
+{
+  len = min( len, reader.bytes_buffered() );
+  if ( len == 0 ) {
+    return { empty_, 0, 0 };
+  }
+
+  const uint64_t offset = allocate( len );
+  bytes_in_use_ += len;
+  live_slices_ += 1;
+  string& storage = buffer_;
+  for ( uint64_t copied = 0; copied < len; ) {
+    const string_view chunk = reader.peek().substr( 0, len - copied );
+    chunk.copy( storage.data() + offset + copied, chunk.size() );
+    reader.pop( chunk.size() );
+    copied += chunk.size();
+  }
+  return { buffer_, offset, len };
+}
+
+void RetransmissionRing::discard_last( const BufferSlice& slice )
+{
+  if ( slice.length == 0 or not owns( slice ) ) {
+    return;
+  }
+  bytes_in_use_ -= slice.length;
+  live_slices_ -= 1;
+  tail_ = slice.offset;
+  if ( wrapped_ and tail_ == 0 ) {
+    wrapped_ = false;
+    tail_ = wrap_end_;
+  }
+}
+
+void RetransmissionRing::release( const BufferSlice& slice )
+{
+  if ( slice.length == 0 or not owns( slice ) ) {
+    return;
+  }
+  bytes_in_use_ -= slice.length;
+  live_slices_ -= 1;
+  head_ = slice.offset + slice.length;
+  if ( wrapped_ and head_ == wrap_end_ ) {
+    wrapped_ = false;
+    head_ = 0;
+  }
+}
+
+bool RetransmissionRing::owns( const BufferSlice& slice ) const
+{
+  return string_view( slice.buffer ).data() == string_view( buffer_ ).data();
+}
+
+bool RetransmissionRing::may_reuse() const
+{
+  return buffer_.use_count() == 1 + live_slices_;
+}
+
+uint64_t RetransmissionRing::allocate( uint64_t len )
+{
+  // Released space can only be written again if no slice of it is held outside the ring.
+  const bool reuse = may_reuse();
+  if ( bytes_in_use_ == 0 and reuse ) {
+    head_ = tail_ = 0;
+    wrapped_ = false;
+  }
+
+  if ( not wrapped_ ) {
+    if ( capacity() - tail_ >= len and ( reuse or tail_ >= written_end_ ) ) {
+      written_end_ = max( written_end_, tail_ + len );
+      return exchange( tail_, tail_ + len );
+    }
+    if ( head_ >= len and reuse ) {
+      wrapped_ = true;
+      wrap_end_ = tail_;
+      tail_ = len;
+      return 0;
+    }
+  } else if ( head_ - tail_ >= len and reuse ) {
+    return exchange( tail_, tail_ + len );
+  }
+
+  // Full (or only released space is left, and it is still shared): move on to a new buffer, twice the size if
+  // the ring ran out of room, leaving the bytes in use where they are.
+  buffer_ = Buffer { string( max( reuse ? 2 * capacity() : capacity(), len ), 0 ) };
+  head_ = 0;
+  tail_ = len;
+  written_end_ = len;
+  wrapped_ = false;
+  bytes_in_use_ = 0;
+  live_slices_ = 0;
+  return 0;
+}
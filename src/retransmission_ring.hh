@@ -0,0 +1,53 @@
+#pragma once
+
+#include "buffer.hh"
+#include "byte_stream.hh"
+
+#include <cstdint>
+
+/*
+ * The unacknowledged bytes of a TCPSender's outbound stream, kept in one ring buffer that the payloads of its
+ * segments are slices of, so a segment is copied out of the stream once and never again, however often it is
+ * (re)transmitted.
+ *
+ * Each append is contiguous in the ring: one that does not fit before the end wraps around to the start
+ * (leaving the tail of the buffer unused until the ring drains past it). Space is released in append order as
+ * segments are acknowledged. When the ring is full, it moves on to a new buffer of twice the size; slices of
+ * the old buffer stay valid, as they share it, and it is freed with the last of them.
+ *
+ * Released space is written again only while the ring's own slices are the only ones sharing the buffer. If a
+ * copy of a slice is held elsewhere (e.g. a sent message the caller kept), the ring moves on to a fresh buffer
+ * instead, so a slice's bytes never change under it.
+ */
+class RetransmissionRing
+{
+  static constexpr uint64_t INITIAL_CAPACITY = 16 * 1024;
+
+  Buffer buffer_ { std::string( INITIAL_CAPACITY, 0 ) };
+  Buffer empty_ {};          // what empty slices refer to, so they never share buffer_
+  uint64_t head_ = 0;        // offset of the oldest byte in use
+  uint64_t tail_ = 0;        // offset just past the newest byte in use
+  uint64_t wrap_end_ = 0;    // when wrapped, the end of the bytes in use in [head_, capacity)
+  uint64_t written_end_ = 0; // offset just past the highest byte ever written in this buffer
+  bool wrapped_ = false;
+  uint64_t bytes_in_use_ = 0;
+  long live_slices_ = 0; // appends from this buffer not yet released or discarded
+
+public:
+  // Pop `len` bytes (at most those buffered) from `reader` into the ring; returns the slice holding them.
+  BufferSlice append( Reader& reader, uint64_t len );
+
+  // Undo the most recent append (which returned `slice`).
+  void discard_last( const BufferSlice& slice );
+
+  // Release the oldest bytes in use, which must be the whole of an earlier append's `slice`.
+  void release( const BufferSlice& slice );
+
+  uint64_t capacity() const { return buffer_.size(); }
+  uint64_t bytes_in_use() const { return bytes_in_use_; } // In the current buffer
+
+private:
+  bool owns( const BufferSlice& slice ) const; // Is `slice` from the current buffer (not an outgrown one)?
+  bool may_reuse() const;                       // Is every sharer of the buffer the ring or one of its slices?
+  uint64_t allocate( uint64_t len );           // Reserve `len` contiguous bytes; returns their offset
+};
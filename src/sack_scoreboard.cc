@@ -0,0 +1,168 @@
+#include "sack_scoreboard.hh"
+
+#include <algorithm>
+#include <iterator>
+
+using namespace std;
+
+void SACKScoreboard::sent( uint64_t begin, uint64_t length )
+{
+  segments_.push_back( { begin, begin + length } );
+  count( segments_.back() );
+}
+
+void SACKScoreboard::acked( uint64_t ackno )
+{
+  while ( not segments_.empty() and segments_.front().end <= ackno ) {
+    uncount( segments_.front() );
+    segments_.pop_front();
+  }
+
+  while ( not sacked_runs_.empty() and sacked_runs_.begin()->second <= ackno ) {
+    sacked_runs_.erase( sacked_runs_.begin() );
+  }
+  erase_if( highest_sacked_,
+            [&]( uint64_t begin ) { return segments_.empty() or begin < segments_.front().begin; } );
+}
+
+void SACKScoreboard::sacked( uint64_t begin, uint64_t end )
+{
+  // Receivers repeat their blocks on every ack: skip over the runs of segments SACKed already, and only look
+  // at the gaps between them.
+  for ( uint64_t pos = begin; pos < end; ) {
+    const auto run = sacked_runs_.upper_bound( pos );
+    if ( run != sacked_runs_.begin() and prev( run )->second > pos ) {
+      pos = prev( run )->second;
+      continue;
+    }
+    const uint64_t gap_end = run == sacked_runs_.end() ? end : min( end, run->first );
+    sack_segments( pos, gap_end, begin, end );
+    pos = gap_end;
+  }
+
+  if ( highest_sacked_.size() == DUP_THRESH ) {
+    mark_lost_below( highest_sacked_.front() );
+  }
+}
+
+void SACKScoreboard::mark_lost( size_t index )
+{
+  if ( index < segments_.size() and not segments_[index].sacked ) {
+    uncount( segments_[index] );
+    segments_[index].lost = true;
+    count( segments_[index] );
+  }
+}
+
+void SACKScoreboard::mark_all_holes_lost()
+{
+  for ( auto& segment : segments_ ) {
+    uncount( segment );
+    segment.retransmitted = false;
+    count( segment );
+  }
+  if ( not highest_sacked_.empty() ) {
+    mark_lost_below( highest_sacked_.back() );
+  }
+}
+
+void SACKScoreboard::retransmitted( size_t index )
+{
+  if ( index < segments_.size() ) {
+    uncount( segments_[index] );
+    segments_[index].lost = true;
+    segments_[index].retransmitted = true;
+    count( segments_[index] );
+  }
+}
+
+optional<size_t> SACKScoreboard::next_hole() const
+{
+  if ( holes_.empty() ) {
+    return {};
+  }
+  return ranges::lower_bound( segments_, *holes_.begin(), {}, &Segment::begin ) - segments_.begin();
+}
+
+bool SACKScoreboard::is_lost( size_t index ) const
+{
+  return index < segments_.size() and segments_[index].lost;
+}
+
+void SACKScoreboard::uncount( const Segment& segment )
+{
+  if ( in_pipe( segment ) ) {
+    pipe_ -= segment.end - segment.begin;
+  }
+  if ( segment.sacked ) {
+    sacked_sequence_numbers_ -= segment.end - segment.begin;
+  }
+  if ( is_hole( segment ) ) {
+    holes_.erase( segment.begin );
+  }
+}
+
+void SACKScoreboard::count( const Segment& segment )
+{
+  if ( in_pipe( segment ) ) {
+    pipe_ += segment.end - segment.begin;
+  }
+  if ( segment.sacked ) {
+    sacked_sequence_numbers_ += segment.end - segment.begin;
+  }
+  if ( is_hole( segment ) ) {
+    holes_.insert( segment.begin );
+  }
+}
+
+void SACKScoreboard::sack_segments( uint64_t begin, uint64_t end, uint64_t block_begin, uint64_t block_end )
+{
+  // Only whole segments count: a block covering part of one leaves the rest of it missing.
+  for ( auto it = ranges::upper_bound( segments_, begin, {}, &Segment::end );
+        it != segments_.end() and it->begin < end;
+        ++it ) {
+    if ( it->sacked or it->begin < block_begin or it->end > block_end ) {
+      continue;
+    }
+    uncount( *it );
+    it->sacked = true;
+    count( *it );
+    add_sacked_run( it->begin, it->end );
+
+    highest_sacked_.insert( ranges::upper_bound( highest_sacked_, it->begin ), it->begin );
+    if ( highest_sacked_.size() > DUP_THRESH ) {
+      highest_sacked_.erase( highest_sacked_.begin() );
+    }
+  }
+}
+
+void SACKScoreboard::add_sacked_run( uint64_t begin, uint64_t end )
+{
+  auto next = sacked_runs_.lower_bound( begin );
+  if ( next != sacked_runs_.end() and next->first == end ) {
+    end = next->second;
+    next = sacked_runs_.erase( next );
+  }
+  if ( next != sacked_runs_.begin() and prev( next )->second == begin ) {
+    prev( next )->second = end;
+  } else {
+    sacked_runs_.emplace_hint( next, begin, end );
+  }
+}
+
+void SACKScoreboard::mark_lost_below( uint64_t seqno )
+{
+  if ( seqno <= lost_below_ ) {
+    return;
+  }
+  for ( auto it = ranges::lower_bound( segments_, lost_below_, {}, &Segment::begin );
+        it != segments_.end() and it->begin < seqno;
+        ++it ) {
+    if ( not it->sacked and not it->lost ) {
+      uncount( *it );
+      it->lost = true;
+      count( *it );
+    }
+  }
+  lost_below_ = seqno;
+}
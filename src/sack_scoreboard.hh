@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <optional>
+#include <set>
+#include <vector>
+
+/*
+ * What a TCPSender knows about the segments it has sent that are not yet cumulatively acknowledged, in the
+ * spirit of the RFC 6675 scoreboard: which ones the receiver reported holding (SACKed), which are deemed lost,
+ * and which of the lost ones have already been retransmitted.
+ *
+ * A segment is lost once DUP_THRESH segments above it have been SACKed (or, after a timeout, once any segment
+ * above it has been), so that every hole in a window can be repaired within one round trip. Entries are
+ * indexed oldest first, and line up one-to-one with the sender's outstanding segments.
+ *
+ * The sender queries the scoreboard on every maybe_send(), and the receiver repeats its SACK blocks on every
+ * ack, so nothing here rescans the window: pipe and SACKed totals are kept as segments change, a repeated
+ * block skips the runs of segments already SACKed, losses are marked only between the old and new loss
+ * boundaries, and the holes awaiting retransmission are kept in order as they open and close.
+ */
+class SACKScoreboard
+{
+public:
+  static constexpr uint64_t DUP_THRESH = 3;
+
+  void sent( uint64_t begin, uint64_t length ); // A new segment went out, covering [begin, begin + length)
+  void acked( uint64_t ackno );                 // Forget the segments the cumulative ackno covers
+  void sacked( uint64_t begin, uint64_t end );  // The receiver holds [begin, end)
+
+  void mark_lost( size_t index );     // e.g. the segment a partial ack stopped at
+  void mark_all_holes_lost();         // After a timeout: everything un-SACKed below SACKed data, resent or not
+  void retransmitted( size_t index ); // The segment was sent again
+
+  std::optional<size_t> next_hole() const; // The oldest lost segment not yet retransmitted
+  bool is_lost( size_t index ) const;
+
+  // RFC 6675 "pipe": sequence numbers still believed to be in the network
+  uint64_t pipe() const { return pipe_; }
+  uint64_t sacked_sequence_numbers() const { return sacked_sequence_numbers_; }
+
+private:
+  struct Segment
+  {
+    uint64_t begin;
+    uint64_t end;
+    bool sacked = false;
+    bool lost = false;
+    bool retransmitted = false;
+  };
+
+  std::deque<Segment> segments_ {};
+  std::map<uint64_t, uint64_t> sacked_runs_ {};   // Contiguous runs of SACKed segments, begin -> end
+  std::vector<uint64_t> highest_sacked_ {};       // Begins of the DUP_THRESH highest SACKed segments, ascending
+  uint64_t lost_below_ = 0;                       // Every un-SACKed segment beginning below this is lost
+  std::set<uint64_t> holes_ {};                   // Begins of the lost segments awaiting retransmission
+  uint64_t pipe_ = 0;
+  uint64_t sacked_sequence_numbers_ = 0;
+
+  static bool is_hole( const Segment& segment )
+  {
+    return segment.lost and not segment.retransmitted and not segment.sacked;
+  }
+  static bool in_pipe( const Segment& segment )
+  {
+    return not segment.sacked and ( not segment.lost or segment.retransmitted );
+  }
+
+  void uncount( const Segment& segment ); // Take a segment out of the totals and holes before changing it...
+  void count( const Segment& segment );   // ...and put it back afterwards
+
+  // SACK the segments within the block [block_begin, block_end) that overlap [begin, end), a gap between runs
+  void sack_segments( uint64_t begin, uint64_t end, uint64_t block_begin, uint64_t block_end );
+  void add_sacked_run( uint64_t begin, uint64_t end );
+  void mark_lost_below( uint64_t seqno ); // Raise lost_below_, marking the un-SACKed segments passed lost
+};
@@ -0,0 +1,144 @@
+#include "spsc_byte_stream.hh"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace std;
+
+SPSCByteStream::SPSCByteStream( uint64_t capacity )
+  : capacity_( capacity ), buffer_( make_unique<char[]>( capacity ) )
+{}
+
+void SPSCWriter::push( string data )
+{
+  if ( is_closed() ) {
+    return;
+  }
+
+  // Only this thread writes bytes_pushed_; bytes_popped_ may grow concurrently, which only adds capacity.
+  const uint64_t pushed = bytes_pushed_.load( memory_order_relaxed );
+  const uint64_t popped = bytes_popped_.load( memory_order_acquire );
+  const uint64_t len = min( capacity_ - ( pushed - popped ), data.size() );
+  if ( len == 0 ) {
+    return;
+  }
+
+  const uint64_t tail = pushed % capacity_;
+  const uint64_t first_part = min( len, capacity_ - tail );
+  memcpy( buffer_.get() + tail, data.data(), first_part );
+  memcpy( buffer_.get(), data.data() + first_part, len - first_part );
+
+  bytes_pushed_.store( pushed + len, memory_order_release );
+}
+
+void SPSCWriter::close()
+{
+  is_closed_.store( true, memory_order_release );
+}
+
+void SPSCWriter::set_error()
+{
+  has_error_.store( true, memory_order_release );
+}
+
+bool SPSCWriter::is_closed() const
+{
+  return is_closed_.load( memory_order_relaxed );
+}
+
+uint64_t SPSCWriter::available_capacity() const
+{
+  return capacity_ - ( bytes_pushed_.load( memory_order_relaxed ) - bytes_popped_.load( memory_order_acquire ) );
+}
+
+uint64_t SPSCWriter::bytes_pushed() const
+{
+  return bytes_pushed_.load( memory_order_relaxed );
+}
+
+string_view SPSCReader::peek() const
+{
+  const uint64_t popped = bytes_popped_.load( memory_order_relaxed );
+  const uint64_t pushed = bytes_pushed_.load( memory_order_acquire );
+  if ( pushed == popped ) {
+    return {};
+  }
+  const uint64_t head = popped % capacity_;
+  return { buffer_.get() + head, min( pushed - popped, capacity_ - head ) };
+}
+
+void SPSCReader::pop( uint64_t len )
+{
+  const uint64_t popped = bytes_popped_.load( memory_order_relaxed );
+  const uint64_t count = min( bytes_pushed_.load( memory_order_acquire ) - popped, len );
+  bytes_popped_.store( popped + count, memory_order_release );
+}
+
+bool SPSCReader::is_finished() const
+{
+  // Load the flag first: once close() is observed, every push that preceded it is visible too.
+  return is_closed_.load( memory_order_acquire ) && bytes_buffered() == 0;
+}
+
+bool SPSCReader::has_error() const
+{
+  return has_error_.load( memory_order_acquire );
+}
+
+uint64_t SPSCReader::bytes_buffered() const
+{
+  return bytes_pushed_.load( memory_order_acquire ) - bytes_popped_.load( memory_order_relaxed );
+}
+
+uint64_t SPSCReader::bytes_popped() const
+{
+  return bytes_popped_.load( memory_order_relaxed );
+}
+
+void read( SPSCReader& reader, uint64_t len, string& out )
+{
+  out.clear();
+
+  while ( out.size() < len ) {
+    auto view = reader.peek();
+    if ( view.empty() ) {
+      return;
+    }
+
+    view = view.substr( 0, len - out.size() ); // Don't return more bytes than desired.
+    out += view;
+    reader.pop( view.size() );
+  }
+}
+
+SPSCReader& SPSCByteStream::reader()
+{
+  static_assert( sizeof( SPSCReader ) == sizeof( SPSCByteStream ),
+                 "Please add member variables to the SPSCByteStream base, not the SPSCByteStream Reader." );
+
+  return static_cast<SPSCReader&>( *this ); // NOLINT(*-downcast)
+}
+
+const SPSCReader& SPSCByteStream::reader() const
+{
+  static_assert( sizeof( SPSCReader ) == sizeof( SPSCByteStream ),
+                 "Please add member variables to the SPSCByteStream base, not the SPSCByteStream Reader." );
+
+  return static_cast<const SPSCReader&>( *this ); // NOLINT(*-downcast)
+}
+
+SPSCWriter& SPSCByteStream::writer()
+{
+  static_assert( sizeof( SPSCWriter ) == sizeof( SPSCByteStream ),
+                 "Please add member variables to the SPSCByteStream base, not the SPSCByteStream Writer." );
+
+  return static_cast<SPSCWriter&>( *this ); // NOLINT(*-downcast)
+}
+
+const SPSCWriter& SPSCByteStream::writer() const
+{
+  static_assert( sizeof( SPSCWriter ) == sizeof( SPSCByteStream ),
+                 "Please add member variables to the SPSCByteStream base, not the SPSCByteStream Writer." );
+
+  return static_cast<const SPSCWriter&>( *this ); // NOLINT(*-downcast)
+}
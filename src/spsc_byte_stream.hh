@@ -0,0 +1,82 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+class SPSCReader;
+class SPSCWriter;
+
+/*
+ * A ByteStream that may be written by one thread and read by another at the same time.
+ *
+ * The writer thread owns bytes_pushed_ (the ring's tail) and the reader thread owns bytes_popped_ (its head).
+ * Each side publishes its counter with a release store and observes the other's with an acquire load,
+ * so the bytes copied into (or out of) the ring are visible before the counter that covers them.
+ * There is no lock: a full writer or an empty reader simply sees zero capacity or zero bytes and retries.
+ */
+class SPSCByteStream
+{
+protected:
+  // Keep the two counters on separate cache lines so the threads don't invalidate each other's line.
+  static constexpr size_t kCacheLineSize = 64;
+
+  uint64_t capacity_;
+  std::unique_ptr<char[]> buffer_;
+  alignas( kCacheLineSize ) std::atomic<uint64_t> bytes_pushed_ { 0 };
+  alignas( kCacheLineSize ) std::atomic<uint64_t> bytes_popped_ { 0 };
+  alignas( kCacheLineSize ) std::atomic<bool> is_closed_ { false };
+  std::atomic<bool> has_error_ { false };
+
+public:
+  explicit SPSCByteStream( uint64_t capacity );
+
+  // The counters are shared with another thread, so the stream can be neither copied nor moved.
+  SPSCByteStream( const SPSCByteStream& other ) = delete;
+  SPSCByteStream& operator=( const SPSCByteStream& other ) = delete;
+  SPSCByteStream( SPSCByteStream&& other ) = delete;
+  SPSCByteStream& operator=( SPSCByteStream&& other ) = delete;
+  ~SPSCByteStream() = default;
+
+  // Access the stream's Reader (for the consuming thread) and Writer (for the producing thread)
+  SPSCReader& reader();
+  const SPSCReader& reader() const;
+  SPSCWriter& writer();
+  const SPSCWriter& writer() const;
+};
+
+// Must only be used from the producing thread.
+class SPSCWriter : public SPSCByteStream
+{
+public:
+  void push( std::string data ); // Push data to stream, but only as much as available capacity allows.
+
+  void close();     // Signal that the stream has reached its ending. Nothing more will be written.
+  void set_error(); // Signal that the stream suffered an error.
+
+  bool is_closed() const;              // Has the stream been closed?
+  uint64_t available_capacity() const; // How many bytes can be pushed to the stream right now?
+  uint64_t bytes_pushed() const;       // Total number of bytes cumulatively pushed to the stream
+};
+
+// Must only be used from the consuming thread.
+class SPSCReader : public SPSCByteStream
+{
+public:
+  std::string_view peek() const; // Peek at the next bytes in the buffer
+  void pop( uint64_t len );      // Remove `len` bytes from the buffer
+
+  bool is_finished() const; // Is the stream finished (closed and fully popped)?
+  bool has_error() const;   // Has the stream had an error?
+
+  uint64_t bytes_buffered() const; // Number of bytes currently buffered (pushed and not popped)
+  uint64_t bytes_popped() const;   // Total number of bytes cumulatively popped from stream
+};
+
+/*
+ * read: A helper function that peeks and pops up to `len` bytes
+ * from an SPSCByteStream Reader into a string;
+ */
+void read( SPSCReader& reader, uint64_t len, std::string& out );
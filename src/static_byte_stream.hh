@@ -0,0 +1,32 @@
+#pragma once
+
+#include "byte_stream.hh"
+
+#include <array>
+#include <cstddef>
+
+/*
+ * A ByteStream whose capacity N is fixed at compile time and whose bytes live in an inline std::array,
+ * so it never allocates. N must be a power of two: ring positions then wrap with a mask.
+ *
+ * It *is* a ByteStream, so reader(), writer(), read() and the Reassembler all work with it unchanged.
+ * Copy it as a StaticByteStream (not through a ByteStream&) to keep the copy allocation-free.
+ */
+template<size_t N>
+class StaticByteStream : public ByteStream
+{
+  static_assert( N > 0 and ( N & ( N - 1 ) ) == 0, "StaticByteStream capacity must be a power of two" );
+
+  std::array<char, N> buffer_ {};
+
+public:
+  StaticByteStream() : ByteStream( N, std::in_place_type<FixedRing>, std::span<char> { buffer_ } ) {}
+
+  StaticByteStream( const StaticByteStream& other ) : StaticByteStream() { *this = other; }
+  StaticByteStream& operator=( const StaticByteStream& other )
+  {
+    ByteStream::operator=( other ); // copies the bytes into this stream's own buffer_
+    return *this;
+  }
+  ~StaticByteStream() = default;
+};
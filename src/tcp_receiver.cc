@@ -20,10 +20,20 @@ void TCPReceiver::receive( TCPSenderMessage message, Reassembler& reassembler, W
   if ( message.SYN ) {
     isn_ = message.seqno;
     ackno_ = isn_.value() + message.sequence_length();
-    reassembler.insert( 0, message.payload, message.FIN, inbound_stream );
+    // Scale windows only if both SYNs carry the option, the peer's and our own (RFC 7323), and then just enough
+    // to advertise the capacity. A shift over 14 is taken as 14.
+    peer_window_scale_.reset();
+    window_scale_.reset();
+    if ( message.window_scale.has_value() ) {
+      peer_window_scale_ = min( message.window_scale.value(), TCPReceiverMessage::MAX_WINDOW_SCALE );
+      if ( window_scaling_ ) {
+        window_scale_ = TCPReceiverMessage::window_scale_for( inbound_stream.available_capacity() );
+      }
+    }
+    reassembler.insert( 0, std::move( message.payload ), message.FIN, inbound_stream );
   } else if ( isn_.has_value() ) {
     reassembler.insert( message.seqno.unwrap( isn_.value(), inbound_stream.bytes_pushed() ) - 1,
-                        message.payload,
+                        std::move( message.payload ),
                         message.FIN,
                         inbound_stream );
     ackno_ = Wrap32::wrap( inbound_stream.bytes_pushed() + 1, isn_.value() );
@@ -35,13 +45,23 @@ void TCPReceiver::receive( TCPSenderMessage message, Reassembler& reassembler, W
     ackno_ = ackno_ + 1;
     inbound_stream.close();
   }
+  held_interval_count_ = reassembler.held_intervals( held_intervals_ );
 }
 
 TCPReceiverMessage TCPReceiver::send( const Writer& inbound_stream ) const
 {
-  const uint16_t window_size = min( MAX_RWND_SIZE, inbound_stream.available_capacity() );
+  const uint64_t scale = window_scale_.value_or( 0 );
+  const uint16_t window_size = min( MAX_RWND_SIZE, inbound_stream.available_capacity() >> scale );
   if ( !isn_.has_value() ) {
     return { {}, window_size };
   }
-  return { ackno_, window_size };
+  TCPReceiverMessage message { ackno_, window_size };
+  message.window_scale = window_scale_;
+  for ( size_t i = 0; i < held_interval_count_; i++ ) {
+    // Stream index i is absolute sequence number i + 1 (the SYN comes first).
+    const auto [begin, end] = held_intervals_[i];
+    message.sack_blocks[i] = { Wrap32::wrap( begin + 1, isn_.value() ), Wrap32::wrap( end + 1, isn_.value() ) };
+  }
+  message.sack_block_count = static_cast<uint8_t>( held_interval_count_ );
+  return message;
 }
@@ -1,9 +1,13 @@
 #pragma once
 
 #include "reassembler.hh"
+#include "tcp_config.hh"
 #include "tcp_receiver_message.hh"
 #include "tcp_sender_message.hh"
 
+#include <array>
+#include <utility>
+
 #define MAX_RWND_SIZE ( ( 1UL << 16 ) - 1 )
 
 class TCPReceiver
@@ -12,14 +16,35 @@ private:
   std::optional<Wrap32> isn_ {};
   std::optional<Wrap32> FIN_seqno_ {};
   Wrap32 ackno_ { 0 };
+  bool window_scaling_ = false;                 // if our side's SYN offers window scaling too
+  std::optional<uint8_t> peer_window_scale_ {}; // the shift the peer's SYN offered, at most 14
+  std::optional<uint8_t> window_scale_ {};      // our shift, if both SYNs offered window scaling
+
+  // Stream indices [begin, end) held by the Reassembler beyond the ackno, as of the last receive()
+  std::array<std::pair<uint64_t, uint64_t>, TCPReceiverMessage::MAX_SACK_BLOCKS> held_intervals_ {};
+  size_t held_interval_count_ = 0;
 
 public:
+  TCPReceiver() = default;
+
+  /* Construct a TCPReceiver for a side of the connection that offers window scaling if `config` enables it */
+  explicit TCPReceiver( const TCPConfig& config ) : window_scaling_( config.window_scaling ) {}
+
   /*
    * The TCPReceiver receives TCPSenderMessages, inserting their payload into the Reassembler
    * at the correct stream index.
    */
   void receive( TCPSenderMessage message, Reassembler& reassembler, Writer& inbound_stream );
 
-  /* The TCPReceiver sends TCPReceiverMessages back to the TCPSender. */
+  /*
+   * The TCPReceiver sends TCPReceiverMessages (with SACK blocks for out-of-order data, and the window scale if
+   * both SYNs offered window scaling) back to the TCPSender.
+   */
   TCPReceiverMessage send( const Writer& inbound_stream ) const;
+
+  /* The shift to apply to the windows the peer advertises, if both SYNs offered window scaling */
+  std::optional<uint8_t> peer_window_scale() const
+  {
+    return window_scale_.has_value() ? peer_window_scale_ : std::nullopt;
+  }
 };
@@ -1,33 +1,115 @@
 #include "tcp_sender.hh"
 #include "tcp_config.hh"
 
+#include <algorithm>
 #include <random>
 
 using namespace std;
 
+namespace {
+CongestionControl make_congestion_control( TCPConfig::CongestionAlgorithm algorithm )
+{
+  switch ( algorithm ) {
+    case TCPConfig::CongestionAlgorithm::NewReno:
+      return NewReno { TCPConfig::MAX_PAYLOAD_SIZE };
+    case TCPConfig::CongestionAlgorithm::CUBIC:
+      return Cubic { TCPConfig::MAX_PAYLOAD_SIZE };
+    case TCPConfig::CongestionAlgorithm::None:
+      break;
+  }
+  return UnlimitedWindow {};
+}
+} // namespace
+
 /* TCPSender constructor (uses a random ISN if none given) */
 TCPSender::TCPSender( uint64_t initial_RTO_ms, optional<Wrap32> fixed_isn )
-  : isn_( fixed_isn.value_or( Wrap32 { random_device()() } ) ), timer_( make_unique<Timer>( initial_RTO_ms ) )
+  : isn_( fixed_isn.value_or( Wrap32 { random_device()() } ) )
+  , timer_( make_unique<Timer>( initial_RTO_ms ) )
+  , rtt_estimator_( initial_RTO_ms, 0, UINT64_MAX )
+  , congestion_control_()
 {}
 
+TCPSender::TCPSender( const TCPConfig& config ) : TCPSender( config.rt_timeout, config.fixed_isn )
+{
+  rtt_estimator_ = RTTEstimator { config.rt_timeout, config.min_rt_timeout, config.max_rt_timeout };
+  adaptive_RTO_ = config.adaptive_rt_timeout;
+  if ( adaptive_RTO_ ) {
+    timer_->set_max_RTO( config.max_rt_timeout );
+  }
+  pacing_ = config.pacing;
+  fixed_pacing_rate_ = config.pacing_rate;
+  if ( config.window_scaling ) {
+    window_scale_offer_ = TCPReceiverMessage::window_scale_for( config.recv_capacity );
+  }
+  congestion_control_ = make_congestion_control( config.congestion_algorithm );
+}
+
 optional<TCPSenderMessage> TCPSender::maybe_send()
+{
+  update_pacing_rate();
+  if ( !pacer_.ready() ) {
+    return {};
+  }
+  auto msg = release_segment();
+  if ( msg.has_value() ) {
+    pacer_.spend( msg->sequence_length() );
+  }
+  return msg;
+}
+
+optional<TCPSenderMessage> TCPSender::release_segment()
 {
   if ( retransmit_flag_ && has_outstanding_segment() ) {
     timer_->run();
     retransmit_flag_ = false;
+    scoreboard_.retransmitted( 0 );
     return segments_.front();
   }
+  // Then repair the other holes, oldest first, while the congestion window has room.
+  if ( const auto hole = scoreboard_.next_hole(); hole.has_value() && scoreboard_.pipe() < congestion_window() ) {
+    timer_->run();
+    scoreboard_.retransmitted( *hole );
+    RTT_probe_.reset(); // Karn's rule: a later ack may be for the retransmission
+    return segments_[*hole];
+  }
   if ( has_cached_segment() ) {
+    const uint64_t outstanding = sequence_numbers_outstanding();
+    visit( [&]( auto& cc ) { cc.on_send( outstanding, now_ms_ ); }, congestion_control_ );
     timer_->run();
+    scoreboard_.sent( sent_seqno_, segments_[next_segment_].sequence_length() );
+    sent_seqno_ += segments_[next_segment_].sequence_length();
+    if ( not RTT_probe_.has_value() ) {
+      RTT_probe_ = { sent_seqno_, now_ms_ };
+    }
     return segments_[next_segment_++];
   }
   return {};
 }
 
+void TCPSender::update_pacing_rate()
+{
+  if ( fixed_pacing_rate_ > 0 ) {
+    pacer_.set_rate( static_cast<double>( fixed_pacing_rate_ ) / 1000 );
+    return;
+  }
+  const auto srtt = rtt_estimator_.smoothed_RTT_ms();
+  if ( !pacing_ || !srtt.has_value() ) {
+    pacer_.set_rate( 0 );
+    return;
+  }
+  // Spread the window the sender may fill (cwnd, or the receiver's window if smaller) over one smoothed RTT.
+  const uint64_t receive_window = max( pre_window_size_, TCPConfig::MAX_PAYLOAD_SIZE );
+  const uint64_t window = min( congestion_window(), receive_window );
+  pacer_.set_rate( static_cast<double>( window ) / max( *srtt, 1.0 ) );
+}
+
 void TCPSender::push( Reader& outbound_stream )
 {
-  uint64_t window_size = remaining_window_size_;
-  if ( window_size == 0 && can_use_magic_ ) {
+  // Stay within the receiver's window, and keep no more than cwnd sequence numbers in flight.
+  const uint64_t cwnd = congestion_window();
+  uint64_t window_size
+    = min( remaining_window_size_, cwnd > sequence_numbers_in_flight_ ? cwnd - sequence_numbers_in_flight_ : 0 );
+  if ( remaining_window_size_ == 0 && can_use_magic_ ) {
     can_use_magic_ = false;
     window_size = 1;
   }
@@ -38,16 +120,13 @@ void TCPSender::push( Reader& outbound_stream )
     if ( absolute_seqno_ == 0 ) {
       window_size -= 1;
       msg.SYN = true;
+      msg.window_scale = window_scale_offer_;
     }
 
-    // Deal with payload
-    uint64_t payload_size = min( { TCPConfig::MAX_PAYLOAD_SIZE, window_size, outbound_stream.bytes_buffered() } );
-    if ( payload_size > 0 ) {
-      string payload {};
-      read( outbound_stream, payload_size, payload );
-      window_size -= payload.size();
-      msg.payload = std::move( payload );
-    }
+    // Deal with payload: the bytes are copied into the retransmission ring once, and every (re)transmission
+    // of the segment shares them.
+    msg.payload = ring_.append( outbound_stream, min( TCPConfig::MAX_PAYLOAD_SIZE, window_size ) );
+    window_size -= msg.payload.size();
 
     // Deal with FIN
     if ( window_size > 0 && outbound_stream.is_finished() && !pre_segment_has_FIN_ ) {
@@ -60,15 +139,15 @@ void TCPSender::push( Reader& outbound_stream )
     }
     if ( msg.FIN && !available_to_send_FIN_ ) {
       pre_segment_has_FIN_ = false;
+      ring_.discard_last( msg.payload );
       return;
     }
 
     msg.seqno = Wrap32::wrap( absolute_seqno_, isn_ );
     absolute_seqno_ += msg.sequence_length();
     sequence_numbers_in_flight_ += msg.sequence_length();
+    remaining_window_size_ -= min( remaining_window_size_, msg.sequence_length() );
     segments_.push_back( std::move( msg ) );
-
-    remaining_window_size_ = window_size;
   }
 }
 
@@ -91,49 +170,131 @@ void TCPSender::receive( const TCPReceiverMessage& msg )
     return;
   }
 
+  // The window is scaled only if our SYN offered window scaling (RFC 7323).
+  const uint64_t window_size = msg.window( window_scale_offer_.has_value() );
+
   // Don't add FIN if this would make the segment exceed the receiver's window
-  available_to_send_FIN_ = msg.window_size + current_unwraped_ackno > absolute_seqno_;
-  if ( msg.window_size == 0 ) {
+  available_to_send_FIN_ = window_size + current_unwraped_ackno > absolute_seqno_;
+  if ( window_size == 0 ) {
     available_to_send_FIN_ = current_unwraped_ackno >= absolute_seqno_;
     can_use_magic_ = true;
   }
 
-  remaining_window_size_ = msg.window_size;
-  window_is_zero_ = msg.window_size == 0;
+  const uint64_t window_end = current_unwraped_ackno + window_size;
+  remaining_window_size_ = window_end - min( window_end, absolute_seqno_ );
+  window_is_zero_ = window_size == 0;
+  receive_sack_blocks( msg );
 
   if ( pre_unwarped_ackno_ < current_unwraped_ackno ) {
     receive_new_ack( current_unwraped_ackno );
+  } else if ( msg.ackno.has_value() && current_unwraped_ackno == pre_unwarped_ackno_
+              && window_size == pre_window_size_ && window_size > 0
+              && sequence_numbers_outstanding() > 0 ) {
+    receive_duplicate_ack();
   }
+  pre_window_size_ = window_size;
+  update_pacing_rate();
 }
 
 void TCPSender::receive_new_ack( uint64_t new_unwraped_ackno )
 {
-  timer_->set_RTO_by_factor( 0 );
+  bool sampled = false;
+  if ( RTT_probe_.has_value() && RTT_probe_->first <= new_unwraped_ackno ) {
+    rtt_estimator_.sample( now_ms_ - RTT_probe_->second );
+    RTT_probe_.reset();
+    sampled = true;
+  }
+  if ( !adaptive_RTO_ ) {
+    timer_->set_RTO_by_factor( 0 );
+  } else if ( sampled ) {
+    // Karn's rule: an ack without a fresh sample (i.e. for retransmitted data) keeps the backed-off RTO.
+    timer_->set_base_RTO( rtt_estimator_.RTO_ms() );
+    timer_->set_RTO_by_factor( 0 );
+  }
   if ( has_outstanding_segment() ) {
     timer_->restart();
   }
   consecutive_retransmissions_ = 0;
+  duplicate_acks_ = 0;
+  const uint64_t bytes_acked = new_unwraped_ackno - pre_unwarped_ackno_;
   pre_unwarped_ackno_ = new_unwraped_ackno;
   remove_acked_segment( new_unwraped_ackno );
+
+  if ( !in_fast_recovery_ ) {
+    visit( [&]( auto& cc ) { cc.on_ack( bytes_acked, now_ms_ ); }, congestion_control_ );
+  } else if ( new_unwraped_ackno >= recover_ ) {
+    in_fast_recovery_ = false;
+    const uint64_t outstanding = sequence_numbers_outstanding();
+    visit( [&]( auto& cc ) { cc.on_recovery_exit( outstanding ); }, congestion_control_ );
+  } else {
+    // A partial ack: the segment after the acknowledged data was lost too, so resend it straight away.
+    visit( [&]( auto& cc ) { cc.on_partial_ack( bytes_acked ); }, congestion_control_ );
+    scoreboard_.mark_lost( 0 );
+  }
+}
+
+void TCPSender::receive_duplicate_ack()
+{
+  duplicate_acks_ += 1;
+  if ( in_fast_recovery_ ) {
+    visit( []( auto& cc ) { cc.on_duplicate_ack(); }, congestion_control_ );
+    return;
+  }
+
+  // The third duplicate ack means the first unacknowledged segment was lost, not just reordered. Acks that do
+  // not cover `recover_` are from the window of an earlier loss, and would only retransmit it again.
+  // SACK blocks can show the loss sooner, when enough data above it has arrived.
+  if ( ( duplicate_acks_ >= 3 || scoreboard_.is_lost( 0 ) ) && pre_unwarped_ackno_ > recover_ ) {
+    const uint64_t outstanding = sequence_numbers_outstanding();
+    visit( [&]( auto& cc ) { cc.on_fast_retransmit( outstanding, now_ms_ ); }, congestion_control_ );
+    in_fast_recovery_ = true;
+    recover_ = sent_seqno_;
+    scoreboard_.mark_lost( 0 );
+    retransmit_flag_ = true;
+    RTT_probe_.reset(); // Karn's rule
+    fast_retransmissions_ += 1;
+  }
 }
 
 void TCPSender::remove_acked_segment( uint64_t unwraped_ackno )
 {
+  // Outstanding segments all lie within one window of the ackno, so comparing wrapped seqnos is enough.
+  const Wrap32 ackno = Wrap32::wrap( unwraped_ackno, isn_ );
   while ( has_outstanding_segment() ) {
     auto it = segments_.cbegin();
-    const uint64_t end_absolute_seqno = it->seqno.unwrap( isn_, absolute_seqno_ ) + it->sequence_length();
-    if ( unwraped_ackno < end_absolute_seqno ) {
+    if ( ackno < it->seqno + static_cast<uint32_t>( it->sequence_length() ) ) {
       // This segment hasn't been fully acked yet.
       return;
     }
     sequence_numbers_in_flight_ -= it->sequence_length();
+    ring_.release( it->payload );
     segments_.pop_front();
     next_segment_ -= 1;
   }
 }
 
+void TCPSender::receive_sack_blocks( const TCPReceiverMessage& msg )
+{
+  if ( !msg.ackno.has_value() ) {
+    return;
+  }
+  const uint64_t ackno = msg.ackno->unwrap( isn_, absolute_seqno_ );
+  scoreboard_.acked( ackno );
+  for ( size_t i = 0; i < min<size_t>( msg.sack_block_count, msg.sack_blocks.size() ); i++ ) {
+    // Ignore blocks that are not above the ackno and within what has been sent, e.g. from a confused peer.
+    const SACKBlock& block = msg.sack_blocks.at( i );
+    const uint64_t begin = block.begin.unwrap( isn_, ackno );
+    const uint64_t end = block.end.unwrap( isn_, ackno );
+    if ( ackno < begin && begin < end && end <= sent_seqno_ ) {
+      scoreboard_.sacked( begin, end );
+    }
+  }
+}
+
 void TCPSender::tick( uint64_t ms_since_last_tick )
 {
+  now_ms_ += ms_since_last_tick;
+  pacer_.refill( now_ms_ );
   if ( !has_outstanding_segment() && !has_cached_segment() ) {
     timer_->stop();
     return;
@@ -141,7 +302,13 @@ void TCPSender::tick( uint64_t ms_since_last_tick )
   timer_->elapse( ms_since_last_tick );
   if ( timer_->expired() ) {
     retransmit_flag_ = true;
+    RTT_probe_.reset(); // Karn's rule: the ack for a retransmitted segment is ambiguous
     if ( !window_is_zero_ ) {
+      in_fast_recovery_ = false;
+      recover_ = sent_seqno_;
+      scoreboard_.mark_all_holes_lost();
+      const uint64_t outstanding = sequence_numbers_outstanding();
+      visit( [&]( auto& cc ) { cc.on_timeout( outstanding ); }, congestion_control_ );
       consecutive_retransmissions_ += 1;
       timer_->set_RTO_by_factor( 2 );
     } else {
@@ -161,6 +328,11 @@ bool TCPSender::has_cached_segment() const
   return next_segment_ != segments_.size();
 }
 
+uint64_t TCPSender::sequence_numbers_outstanding() const
+{
+  return sent_seqno_ - min( sent_seqno_, pre_unwarped_ackno_ );
+}
+
 // for use in testing
 uint64_t TCPSender::sequence_numbers_in_flight() const
 {
@@ -171,3 +343,53 @@ uint64_t TCPSender::consecutive_retransmissions() const
 {
   return consecutive_retransmissions_;
 }
+
+uint64_t TCPSender::congestion_window() const
+{
+  return visit( []( const auto& cc ) { return cc.cwnd(); }, congestion_control_ );
+}
+
+uint64_t TCPSender::slow_start_threshold() const
+{
+  return visit( []( const auto& cc ) { return cc.ssthresh(); }, congestion_control_ );
+}
+
+uint64_t TCPSender::RTO_ms() const
+{
+  return timer_->RTO_ms();
+}
+
+optional<double> TCPSender::smoothed_RTT_ms() const
+{
+  return rtt_estimator_.smoothed_RTT_ms();
+}
+
+double TCPSender::RTT_variation_ms() const
+{
+  return rtt_estimator_.RTT_variation_ms();
+}
+
+uint64_t TCPSender::fast_retransmissions() const
+{
+  return fast_retransmissions_;
+}
+
+bool TCPSender::in_fast_recovery() const
+{
+  return in_fast_recovery_;
+}
+
+uint64_t TCPSender::sequence_numbers_sacked() const
+{
+  return scoreboard_.sacked_sequence_numbers();
+}
+
+double TCPSender::pacing_rate() const
+{
+  return pacer_.rate() * 1000;
+}
+
+uint64_t TCPSender::next_release_ms() const
+{
+  return max( now_ms_, pacer_.next_release_ms() );
+}
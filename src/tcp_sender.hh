@@ -1,21 +1,30 @@
 #pragma once
 
 #include "byte_stream.hh"
+#include "congestion_control.hh"
+#include "retransmission_ring.hh"
+#include "sack_scoreboard.hh"
+#include "tcp_config.hh"
 #include "tcp_receiver_message.hh"
 #include "tcp_sender_message.hh"
+#include <algorithm>
+#include <cmath>
+#include <deque>
 #include <memory>
+#include <optional>
+#include <utility>
 
 class Timer
 {
 private:
   bool is_running_ = false;
-  uint64_t initial_RTO_ms_;
+  uint64_t base_RTO_ms_;
   uint64_t time_elapsed_ = 0;
   uint64_t current_RTO_ms_;
+  uint64_t max_RTO_ms_ = UINT64_MAX;
 
 public:
-  explicit Timer( uint64_t initial_RTO_ms ) : initial_RTO_ms_( initial_RTO_ms ), current_RTO_ms_( initial_RTO_ms )
-  {}
+  explicit Timer( uint64_t initial_RTO_ms ) : base_RTO_ms_( initial_RTO_ms ), current_RTO_ms_( initial_RTO_ms ) {}
 
   void run() { is_running_ = true; }
 
@@ -29,17 +38,25 @@ public:
     }
   }
 
-  // Multiple current_RTO_ms by a factor greater or equal 0.
-  // If factor == 0, reset RTO to initial_RTO_ms.
+  // Multiple current_RTO_ms by a factor greater or equal 0, up to the maximum RTO.
+  // If factor == 0, reset RTO to the base RTO (initially initial_RTO_ms).
   void set_RTO_by_factor( uint8_t factor )
   {
     if ( factor == 0 ) {
-      current_RTO_ms_ = initial_RTO_ms_;
+      current_RTO_ms_ = base_RTO_ms_;
+    } else if ( current_RTO_ms_ > max_RTO_ms_ / factor ) {
+      current_RTO_ms_ = max_RTO_ms_;
     } else {
       current_RTO_ms_ *= factor;
     }
   }
 
+  // Change the RTO that set_RTO_by_factor( 0 ) resets to, e.g. after a new RTT estimate.
+  void set_base_RTO( uint64_t RTO_ms ) { base_RTO_ms_ = RTO_ms; }
+
+  // Limit how far set_RTO_by_factor backs off (unlimited by default).
+  void set_max_RTO( uint64_t RTO_ms ) { max_RTO_ms_ = RTO_ms; }
+
   void stop() { is_running_ = false; }
 
   void expire()
@@ -57,16 +74,113 @@ public:
   bool expired() const { return !is_running_ && time_elapsed_ == 0; }
 
   bool is_running() const { return is_running_; }
+
+  uint64_t RTO_ms() const { return current_RTO_ms_; }
+};
+
+// RFC 6298 round-trip time estimation: a smoothed RTT and its mean deviation, and the RTO they imply.
+class RTTEstimator
+{
+private:
+  static constexpr double ALPHA = 1.0 / 8;
+  static constexpr double BETA = 1.0 / 4;
+  static constexpr double K = 4;
+  static constexpr double GRANULARITY_MS = 1; // tick() counts whole milliseconds
+
+  uint64_t min_RTO_ms_;
+  uint64_t max_RTO_ms_;
+  uint64_t RTO_ms_;
+  std::optional<double> smoothed_RTT_ms_ {};
+  double RTT_variation_ms_ = 0;
+
+public:
+  RTTEstimator( uint64_t initial_RTO_ms, uint64_t min_RTO_ms, uint64_t max_RTO_ms )
+    : min_RTO_ms_( min_RTO_ms ), max_RTO_ms_( max_RTO_ms ), RTO_ms_( initial_RTO_ms )
+  {}
+
+  void sample( uint64_t RTT_ms )
+  {
+    const auto R = static_cast<double>( RTT_ms );
+    if ( not smoothed_RTT_ms_.has_value() ) {
+      smoothed_RTT_ms_ = R;
+      RTT_variation_ms_ = R / 2;
+    } else {
+      RTT_variation_ms_ = ( 1 - BETA ) * RTT_variation_ms_ + BETA * std::abs( *smoothed_RTT_ms_ - R );
+      smoothed_RTT_ms_ = ( 1 - ALPHA ) * *smoothed_RTT_ms_ + ALPHA * R;
+    }
+    const double RTO = *smoothed_RTT_ms_ + std::max( GRANULARITY_MS, K * RTT_variation_ms_ );
+    RTO_ms_ = std::clamp( static_cast<uint64_t>( std::llround( RTO ) ), min_RTO_ms_, max_RTO_ms_ );
+  }
+
+  uint64_t RTO_ms() const { return RTO_ms_; } // The initial RTO until the first sample
+  std::optional<double> smoothed_RTT_ms() const { return smoothed_RTT_ms_; }
+  double RTT_variation_ms() const { return RTT_variation_ms_; }
+};
+
+// A token bucket that spaces segments out: each one spends its sequence length, and tokens refill at `rate`
+// per millisecond of tick() time, up to a small burst. A segment may go whenever the bucket is not in debt, so
+// a segment larger than the burst is still released, and the debt it leaves sets the next release time.
+class Pacer
+{
+private:
+  double rate_ = 0; // tokens per millisecond (0: unpaced)
+  double burst_;
+  double tokens_;
+  uint64_t last_refill_ms_ = 0;
+
+public:
+  explicit Pacer( uint64_t burst ) : burst_( static_cast<double>( burst ) ), tokens_( burst_ ) {}
+
+  void set_rate( double per_ms ) { rate_ = per_ms; }
+
+  void refill( uint64_t now_ms )
+  {
+    // Hold at least one millisecond's worth, or the bucket would cap the rate at `burst` per tick.
+    const double elapsed = static_cast<double>( now_ms - last_refill_ms_ );
+    tokens_ = std::min( std::max( burst_, rate_ ), tokens_ + rate_ * elapsed );
+    last_refill_ms_ = now_ms;
+  }
+
+  bool ready() const { return rate_ == 0 || tokens_ >= 0; }
+
+  void spend( uint64_t sequence_length )
+  {
+    if ( rate_ > 0 ) {
+      tokens_ -= static_cast<double>( sequence_length );
+    }
+  }
+
+  uint64_t next_release_ms() const
+  {
+    if ( ready() ) {
+      return last_refill_ms_;
+    }
+    return last_refill_ms_ + static_cast<uint64_t>( std::ceil( -tokens_ / rate_ ) );
+  }
+
+  double rate() const { return rate_; }
 };
 
 class TCPSender
 {
   Wrap32 isn_;
   std::unique_ptr<Timer> timer_;
+  RTTEstimator rtt_estimator_;
+  bool adaptive_RTO_ = false; // whether the timer's base RTO follows rtt_estimator_
+  // The segment being timed for an RTT sample: its end seqno and when it was sent (by Karn's rule, never one
+  // that has been retransmitted)
+  std::optional<std::pair<uint64_t, uint64_t>> RTT_probe_ {};
+  CongestionControl congestion_control_;
+  uint64_t now_ms_ = 0; // total time passed to tick()
+
+  Pacer pacer_ { 2 * TCPConfig::MAX_PAYLOAD_SIZE };
+  bool pacing_ = false;            // spread each window over the smoothed RTT
+  uint64_t fixed_pacing_rate_ = 0; // or release at this rate, in bytes per second
 
   bool can_use_magic_ = false;
   bool window_is_zero_ = false;
-  uint16_t remaining_window_size_ = 1;
+  uint64_t remaining_window_size_ = 1; // sequence numbers the receiver's window still has room for
+  std::optional<uint8_t> window_scale_offer_ {}; // sent on the SYN, to accept scaled windows (RFC 7323)
 
   // When timer is expired, set this flag to true.
   // Set this flag to false after retransmitting the segment.
@@ -76,18 +190,31 @@ class TCPSender
   bool available_to_send_FIN_ = false;
 
   uint64_t absolute_seqno_ = 0;
+  uint64_t sent_seqno_ = 0; // absolute seqno just past the last segment handed out by maybe_send()
   uint64_t pre_unwarped_ackno_ = 0;
 
   size_t next_segment_ = 0;
-  std::deque<TCPSenderMessage> segments_ {};
+  std::deque<TCPSenderMessage> segments_ {}; // payloads are slices of ring_
+  RetransmissionRing ring_ {};
+  SACKScoreboard scoreboard_ {}; // one entry per outstanding segment, i.e. segments_[0, next_segment_)
 
   uint64_t sequence_numbers_in_flight_ = 0;
   uint64_t consecutive_retransmissions_ = 0;
 
+  // Fast retransmit and NewReno fast recovery (RFC 5681, RFC 6582)
+  uint64_t pre_window_size_ = 0; // an ack that changes the window is not a duplicate
+  uint64_t duplicate_acks_ = 0;
+  bool in_fast_recovery_ = false;
+  uint64_t recover_ = 0; // highest seqno sent when fast recovery (or the last timeout) began
+  uint64_t fast_retransmissions_ = 0;
+
 public:
   /* Construct TCP sender with given default Retransmission Timeout and possible ISN */
   TCPSender( uint64_t initial_RTO_ms, std::optional<Wrap32> fixed_isn );
 
+  /* Construct TCP sender with the timeouts, ISN and congestion control from `config` */
+  explicit TCPSender( const TCPConfig& config );
+
   /* Push bytes from the outbound stream */
   void push( Reader& outbound_stream );
 
@@ -104,12 +231,27 @@ public:
   void tick( uint64_t ms_since_last_tick );
 
   /* Accessors for use in testing */
-  uint64_t sequence_numbers_in_flight() const;  // How many sequence numbers are outstanding?
-  uint64_t consecutive_retransmissions() const; // How many consecutive *re*transmissions have happened?
+  uint64_t sequence_numbers_in_flight() const;   // How many sequence numbers are outstanding?
+  uint64_t consecutive_retransmissions() const;  // How many consecutive *re*transmissions have happened?
+  uint64_t congestion_window() const;            // cwnd, in sequence numbers
+  uint64_t slow_start_threshold() const;         // ssthresh, in sequence numbers
+  uint64_t RTO_ms() const;                       // The current retransmission timeout, including any backoff
+  std::optional<double> smoothed_RTT_ms() const; // SRTT (empty until the first RTT sample)
+  double RTT_variation_ms() const;               // RTTVAR
+  uint64_t fast_retransmissions() const;         // How many times did duplicate acks trigger a retransmission?
+  uint64_t sequence_numbers_sacked() const;      // Outstanding, but reported held by the receiver
+  double pacing_rate() const;                    // In bytes per second (0: unpaced)
+  uint64_t next_release_ms() const;              // When maybe_send() may next release a segment, in tick() time
+  bool in_fast_recovery() const;
 
 private:
+  std::optional<TCPSenderMessage> release_segment();
+  void update_pacing_rate();
   void remove_acked_segment( uint64_t current_unwraped_ackno );
   void receive_new_ack( uint64_t new_unwraped_ackno );
-  bool has_outstanding_segment() const; // sent but unacked
-  bool has_cached_segment() const;      // not yet send but usable
+  void receive_duplicate_ack();
+  void receive_sack_blocks( const TCPReceiverMessage& msg );
+  bool has_outstanding_segment() const;          // sent but unacked
+  bool has_cached_segment() const;               // not yet send but usable
+  uint64_t sequence_numbers_outstanding() const; // sent but unacked, i.e. on the network
 };
@@ -1,7 +1,20 @@
 #include "wrapping_integers.hh"
 
+#include <stdexcept>
+
 using namespace std;
 
+namespace {
+// The absolute sequence number closest to `checkpoint` whose low 32 bits are `offset` (ties go to the lower one)
+uint64_t unwrap_offset( uint32_t offset, uint64_t checkpoint )
+{
+  const int32_t delta = static_cast<int32_t>( offset - static_cast<uint32_t>( checkpoint ) );
+  const uint64_t candidate = checkpoint + static_cast<int64_t>( delta );
+  // The closest value would be negative, so take the next one up instead.
+  return candidate + ( static_cast<uint64_t>( delta < 0 and candidate > checkpoint ) << 32 );
+}
+} // namespace
+
 Wrap32 Wrap32::wrap( uint64_t n, Wrap32 zero_point )
 {
   return zero_point + static_cast<uint32_t>( n );
@@ -9,13 +22,18 @@ Wrap32 Wrap32::wrap( uint64_t n, Wrap32 zero_point )
 
 uint64_t Wrap32::unwrap( Wrap32 zero_point, uint64_t checkpoint ) const
 {
-  uint64_t val = ( ( checkpoint >> 32 ) << 32 );
-  const int64_t offset = raw_value_ - zero_point.raw_value_;
-  if ( offset < 0 ) {
-    val += ( 1UL << 32 );
+  return unwrap_offset( raw_value_ - zero_point.raw_value_, checkpoint );
+}
+
+void Wrap32::unwrap( span<const Wrap32> seqnos,
+                     Wrap32 zero_point,
+                     uint64_t checkpoint,
+                     span<uint64_t> absolute_seqnos )
+{
+  if ( absolute_seqnos.size() < seqnos.size() ) {
+    throw runtime_error( "Wrap32::unwrap: output span is shorter than input" );
+  }
+  for ( size_t i = 0; i < seqnos.size(); i++ ) {
+    absolute_seqnos[i] = unwrap_offset( seqnos[i].raw_value_ - zero_point.raw_value_, checkpoint );
   }
-  val += offset;
-  val = min( { val - ( 1UL << 32 ), val, val + ( 1UL << 32 ) },
-             [checkpoint]( uint64_t a, uint64_t b ) { return DIST( a, checkpoint ) < DIST( b, checkpoint ); } );
-  return val;
 }
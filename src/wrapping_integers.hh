@@ -1,9 +1,8 @@
 #pragma once
 
-#include <algorithm>
 #include <cstdint>
+#include <span>
 
-#define DIST( val, checkpoint ) max( val, checkpoint ) - min( val, checkpoint )
 /*
  * The Wrap32 type represents a 32-bit unsigned integer that:
  *    - starts at an arbitrary "zero point" (initial value), and
@@ -16,7 +15,7 @@ protected:
   uint32_t raw_value_ {};
 
 public:
-  explicit Wrap32( uint32_t raw_value ) : raw_value_( raw_value ) {}
+  explicit constexpr Wrap32( uint32_t raw_value ) : raw_value_( raw_value ) {}
 
   /* Construct a Wrap32 given an absolute sequence number n and the zero point. */
   static Wrap32 wrap( uint64_t n, Wrap32 zero_point );
@@ -30,6 +29,30 @@ public:
    */
   uint64_t unwrap( Wrap32 zero_point, uint64_t checkpoint ) const;
 
-  Wrap32 operator+( uint32_t n ) const { return Wrap32 { raw_value_ + n }; }
-  bool operator==( const Wrap32& other ) const { return raw_value_ == other.raw_value_; }
+  /*
+   * Unwrap every element of `seqnos` against the same zero point and checkpoint into `absolute_seqnos`
+   * (which must be at least as long). Equivalent to calling unwrap() on each, but branch-free so the loop
+   * can be vectorized when a whole window of sequence numbers has to be resolved at once.
+   */
+  static void unwrap( std::span<const Wrap32> seqnos,
+                      Wrap32 zero_point,
+                      uint64_t checkpoint,
+                      std::span<uint64_t> absolute_seqnos );
+
+  constexpr Wrap32 operator+( uint32_t n ) const { return Wrap32 { raw_value_ + n }; }
+  constexpr bool operator==( const Wrap32& other ) const { return raw_value_ == other.raw_value_; }
+
+  /*
+   * Serial-number arithmetic (RFC 1982): the signed distance from `other` to this Wrap32, and the ordering it
+   * implies. Only meaningful when the two values are less than 2^31 apart, which always holds within a TCP
+   * window.
+   */
+  constexpr int32_t operator-( const Wrap32& other ) const
+  {
+    return static_cast<int32_t>( raw_value_ - other.raw_value_ );
+  }
+  constexpr bool operator<( const Wrap32& other ) const { return *this - other < 0; }
+  constexpr bool operator<=( const Wrap32& other ) const { return *this - other <= 0; }
+  constexpr bool operator>( const Wrap32& other ) const { return *this - other > 0; }
+  constexpr bool operator>=( const Wrap32& other ) const { return *this - other >= 0; }
 };
@@ -97,6 +97,48 @@ int main()
       test.execute( BytesBuffered { 1 } );
     }
 
+    {
+      ByteStreamTestHarness test { "wraparound", 4 };
+      test.execute( Push { "abcd" } );
+      test.execute( PeekOnce { "abcd" } );
+      test.execute( Pop { 3 } );
+      test.execute( Push { "efgh" } );
+      test.execute( BytesBuffered { 4 } );
+      test.execute( AvailableCapacity { 0 } );
+      test.execute( Peek { "defg" } );
+      test.execute( PeekOnce { "d" } );
+      test.execute( PeekRegions { { "d", "efg" } } );
+      test.execute( Pop { 1 } );
+      test.execute( PeekOnce { "efg" } );
+      test.execute( Pop { 3 } );
+      test.execute( Push { "wxyz" } );
+      test.execute( PeekOnce { "wxyz" } );
+      test.execute( PeekRegions { { "wxyz" } } );
+      test.execute( BytesPushed { 11 } );
+      test.execute( BytesPopped { 7 } );
+    }
+
+    {
+      ByteStreamTestHarness test { "reserve-commit", 4 };
+      test.execute( ReserveSize { 10, 4 } );
+      test.execute( ReserveCommit { "ab" } );
+      test.execute( BytesPushed { 2 } );
+      test.execute( Pop { 1 } );
+      test.execute( ReserveSize { 10, 2 } );
+      test.execute( ReserveCommit { "cdef" } );
+      test.execute( BytesPushed { 4 } );
+      test.execute( ReserveSize { 10, 1 } );
+      test.execute( ReserveCommit { "ef" } );
+      test.execute( BytesPushed { 5 } );
+      test.execute( ReserveSize { 10, 0 } );
+      test.execute( Peek { "bcde" } );
+      test.execute( PeekRegions { { "bcd", "e" } } );
+      test.execute( Close {} );
+      test.execute( Pop { 4 } );
+      test.execute( ReserveSize { 10, 0 } );
+      test.execute( IsFinished { true } );
+    }
+
   } catch ( const exception& e ) {
     cerr << "Exception: " << e.what() << endl;
     return EXIT_FAILURE;
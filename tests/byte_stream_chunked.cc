@@ -0,0 +1,101 @@
+#include "byte_stream.hh"
+#include "byte_stream_test_harness.hh"
+
+#include <exception>
+#include <iostream>
+
+using namespace std;
+
+// Once the reader has popped a chunk, reserving no more than its size hands the same storage back out.
+struct ReserveReusesPoppedChunk : public Expectation<ByteStream>
+{
+  string description() const override { return "reserve() reuses the storage of a popped chunk"; }
+  void execute( ByteStream& bs ) const override
+  {
+    const auto first = bs.writer().reserve( 100 ); // too long for the short-string buffer
+    const char* storage = first.data();
+    bs.writer().commit( first.size() );
+    bs.reader().pop( bs.reader().bytes_buffered() );
+    const auto second = bs.writer().reserve( 80 );
+    bs.writer().commit( 0 );
+    if ( second.data() != storage ) {
+      throw ExpectationViolation { "reserve() allocated a new chunk instead of reusing the popped one" };
+    }
+  }
+};
+
+int main()
+{
+  try {
+    {
+      ByteStreamTestHarness test { "chunked-peek-front-chunk", "chunked capacity=15", ByteStream::chunked( 15 ) };
+      test.execute( Push { "cat" } );
+      test.execute( Push { "" } );
+      test.execute( Push { "tac" } );
+      test.execute( BytesBuffered { 6 } );
+      test.execute( AvailableCapacity { 9 } );
+      test.execute( PeekOnce { "cat" } );
+      test.execute( Peek { "cattac" } );
+      test.execute( PeekRegions { { "cat", "tac" } } );
+      test.execute( Pop { 1 } );
+      test.execute( PeekOnce { "at" } );
+      test.execute( PeekRegions { { "at", "tac" } } );
+      test.execute( Pop { 3 } );
+      test.execute( PeekOnce { "ac" } );
+      test.execute( BytesPopped { 4 } );
+      test.execute( ReadAll { "ac" } );
+      test.execute( PeekRegions { {} } );
+    }
+
+    {
+      ByteStreamTestHarness test { "chunked-trim-last-chunk", "chunked capacity=4", ByteStream::chunked( 4 ) };
+      test.execute( Push { "ab" } );
+      test.execute( Push { "cdef" } );
+      test.execute( BytesPushed { 4 } );
+      test.execute( AvailableCapacity { 0 } );
+      test.execute( Push { "g" } );
+      test.execute( BytesPushed { 4 } );
+      test.execute( Peek { "abcd" } );
+      test.execute( Pop { 3 } );
+      test.execute( PeekOnce { "d" } );
+      test.execute( Push { "hijk" } );
+      test.execute( BytesPushed { 7 } );
+      test.execute( Peek { "dhij" } );
+    }
+
+    {
+      ByteStreamTestHarness test { "chunked-close", "chunked capacity=4", ByteStream::chunked( 4 ) };
+      test.execute( Push { "abc" } );
+      test.execute( Close {} );
+      test.execute( Push { "d" } );
+      test.execute( IsFinished { false } );
+      test.execute( ReadAll { "abc" } );
+      test.execute( IsFinished { true } );
+      test.execute( BytesPushed { 3 } );
+      test.execute( BytesPopped { 3 } );
+    }
+
+    {
+      ByteStreamTestHarness test { "chunked-reserve-commit", "chunked capacity=6", ByteStream::chunked( 6 ) };
+      test.execute( Push { "ab" } );
+      test.execute( ReserveSize { 10, 4 } );
+      test.execute( ReserveCommit { "cde" } );
+      test.execute( BytesPushed { 5 } );
+      test.execute( PeekRegions { { "ab", "cde" } } );
+      test.execute( ReserveCommit { "fgh" } );
+      test.execute( BytesPushed { 6 } );
+      test.execute( ReadAll { "abcdef" } );
+    }
+
+    {
+      ByteStreamTestHarness test {
+        "chunked-reserve-reuses-chunk", "chunked capacity=1000", ByteStream::chunked( 1000 ) };
+      test.execute( ReserveReusesPoppedChunk {} );
+    }
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,56 @@
+#include "byte_stream.hh"
+#include "byte_stream_test_harness.hh"
+
+#include <exception>
+#include <iostream>
+
+using namespace std;
+
+int main()
+{
+  try {
+    {
+      ByteStreamTestHarness test { "mirrored-basics", "mirrored capacity=15", ByteStream::mirrored( 15 ) };
+      test.execute( Push { "cat" } );
+      test.execute( Push { "tac" } );
+      test.execute( BytesBuffered { 6 } );
+      test.execute( AvailableCapacity { 9 } );
+      test.execute( PeekOnce { "cattac" } );
+      test.execute( Pop { 2 } );
+      test.execute( PeekOnce { "ttac" } );
+      test.execute( Push { "0123456789abcdef" } );
+      test.execute( BytesPushed { 17 } );
+      test.execute( AvailableCapacity { 0 } );
+      test.execute( PeekRegions { { "ttac0123456789a" } } );
+      test.execute( Close {} );
+      test.execute( ReadAll { "ttac0123456789a" } );
+      test.execute( IsFinished { true } );
+    }
+
+    {
+      // The ring is a whole number of pages, so fill it to one byte short of the end to straddle the wrap point.
+      const string filler( 4095, 'x' );
+      ByteStreamTestHarness test { "mirrored-wraparound", "mirrored capacity=4096", ByteStream::mirrored( 4096 ) };
+      test.execute( Push { filler } );
+      test.execute( Pop { 4094 } );
+      test.execute( Push { "abcdefgh" } );
+      test.execute( BytesBuffered { 9 } );
+      test.execute( PeekOnce { "xabcdefgh" } );
+      test.execute( PeekRegions { { "xabcdefgh" } } );
+      test.execute( Peek { "xabcdefgh" } );
+      test.execute( Pop { 3 } );
+      test.execute( PeekOnce { "cdefgh" } );
+      test.execute( ReserveSize { 5000, 4090 } );
+      test.execute( Push { filler } );
+      test.execute( BytesBuffered { 4096 } );
+      test.execute( Pop { 6 } );
+      test.execute( PeekOnce { string( 4090, 'x' ) } );
+      test.execute( BytesPopped { 4103 } );
+    }
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,80 @@
+#include "buffer_pool.hh"
+#include "byte_stream.hh"
+#include "byte_stream_test_harness.hh"
+
+#include <exception>
+#include <iostream>
+#include <memory>
+
+using namespace std;
+
+struct ChunksInUse : public ExpectNumber<ByteStream, size_t>
+{
+  shared_ptr<BufferPool> pool_;
+
+  ChunksInUse( shared_ptr<BufferPool> pool, size_t expected ) : ExpectNumber( expected ), pool_( move( pool ) ) {}
+  std::string name() const override { return "[chunks borrowed from the pool]"; }
+  size_t value( ByteStream& /* unused */ ) const override { return pool_->chunks_in_use(); }
+};
+
+int main()
+{
+  try {
+    {
+      auto pool = make_shared<BufferPool>( 4, 2 );
+      ByteStreamTestHarness test { "pooled-borrow-and-return",
+                                   "pooled capacity=10",
+                                   ByteStream::pooled( 10, pool ) };
+      test.execute( ChunksInUse { pool, 0 } );
+      test.execute( Push { "abcdef" } );
+      test.execute( ChunksInUse { pool, 2 } );
+      test.execute( PeekOnce { "abcd" } );
+      test.execute( PeekRegions { { "abcd", "ef" } } );
+      test.execute( Peek { "abcdef" } );
+      test.execute( ChunksInUse { pool, 2 } );
+      test.execute( Pop { 5 } );
+      test.execute( ChunksInUse { pool, 1 } );
+      test.execute( PeekOnce { "f" } );
+      test.execute( Push { "ghijklmnopq" } );
+      test.execute( BytesPushed { 15 } );
+      test.execute( ChunksInUse { pool, 3 } );
+      test.execute( PeekRegions { { "fgh", "ijkl", "mno" } } );
+      test.execute( ReadAll { "fghijklmno" } );
+      test.execute( ChunksInUse { pool, 0 } );
+      test.execute( ReserveSize { 10, 4 } );
+      test.execute( ReserveCommit { "" } );
+      test.execute( ChunksInUse { pool, 0 } );
+      test.execute( ReserveCommit { "xyz" } );
+      test.execute( ChunksInUse { pool, 1 } );
+      test.execute( ReserveSize { 10, 1 } );
+      test.execute( Close {} );
+      test.execute( ReadAll { "xyz" } );
+      test.execute( IsFinished { true } );
+      test.execute( ChunksInUse { pool, 0 } );
+
+      if ( pool->peak_chunks_in_use() < 3 or pool->chunks_allocated() < pool->peak_chunks_in_use() ) {
+        throw runtime_error( "BufferPool reported inconsistent occupancy" );
+      }
+    }
+
+    {
+      auto pool = make_shared<BufferPool>( 3 );
+      ByteStream first = ByteStream::pooled( 5, pool );
+      ByteStream second = ByteStream::pooled( 5, pool );
+      first.writer().push( "hello world" );
+      second.writer().push( "abc" );
+      if ( pool->chunks_in_use() != 3 ) {
+        throw runtime_error( "two pooled streams should share the pool's chunks" );
+      }
+      first.reader().pop( 5 );
+      if ( pool->chunks_in_use() != 1 ) {
+        throw runtime_error( "a drained pooled stream should give its chunks back" );
+      }
+    }
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,62 @@
+#include "byte_stream.hh"
+#include "byte_stream_test_harness.hh"
+
+#include <exception>
+#include <iostream>
+#include <memory>
+
+using namespace std;
+
+struct Notifications : public ExpectNumber<ByteStream, unsigned>
+{
+  shared_ptr<unsigned> count_;
+  string what_;
+
+  Notifications( shared_ptr<unsigned> count, string what, unsigned expected )
+    : ExpectNumber( expected ), count_( move( count ) ), what_( move( what ) )
+  {}
+  std::string name() const override { return "[" + what_ + " notifications]"; }
+  unsigned value( ByteStream& /* unused */ ) const override { return *count_; }
+};
+
+int main()
+{
+  try {
+    auto readable = make_shared<unsigned>( 0 );
+    auto writable = make_shared<unsigned>( 0 );
+    auto closed = make_shared<unsigned>( 0 );
+
+    ByteStream stream { 8 };
+    stream.reader().on_readable( [readable] { ++*readable; }, 3 );
+    stream.writer().on_writable( [writable] { ++*writable; }, 4 );
+    stream.reader().on_closed( [closed] { ++*closed; } );
+
+    ByteStreamTestHarness test { "readiness-watermarks", "capacity=8 with readiness callbacks", move( stream ) };
+    test.execute( Push { "ab" } );
+    test.execute( Notifications { readable, "readable", 0 } );
+    test.execute( Push { "c" } );
+    test.execute( Notifications { readable, "readable", 1 } );
+    test.execute( Push { "defghij" } );
+    test.execute( Notifications { readable, "readable", 1 } );
+    test.execute( AvailableCapacity { 0 } );
+    test.execute( Pop { 2 } );
+    test.execute( Notifications { writable, "writable", 0 } );
+    test.execute( Pop { 2 } );
+    test.execute( Notifications { writable, "writable", 1 } );
+    test.execute( Pop { 4 } );
+    test.execute( Notifications { writable, "writable", 1 } );
+    test.execute( ReserveCommit { "klm" } );
+    test.execute( Notifications { readable, "readable", 2 } );
+    test.execute( Notifications { closed, "closed", 0 } );
+    test.execute( Close {} );
+    test.execute( Close {} );
+    test.execute( Notifications { closed, "closed", 1 } );
+    test.execute( SetError {} );
+    test.execute( Notifications { closed, "closed", 2 } );
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
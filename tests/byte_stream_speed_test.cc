@@ -1,4 +1,5 @@
 #include "byte_stream.hh"
+#include "static_byte_stream.hh"
 
 #include <chrono>
 #include <cstddef>
@@ -11,7 +12,9 @@
 using namespace std;
 using namespace std::chrono;
 
-void speed_test( const size_t input_len,   // NOLINT(bugprone-easily-swappable-parameters)
+void speed_test( ByteStream& bs,
+                 const string& description,
+                 const size_t input_len,   // NOLINT(bugprone-easily-swappable-parameters)
                  const size_t capacity,    // NOLINT(bugprone-easily-swappable-parameters)
                  const size_t random_seed, // NOLINT(bugprone-easily-swappable-parameters)
                  const size_t write_size,  // NOLINT(bugprone-easily-swappable-parameters)
@@ -34,7 +37,6 @@ void speed_test( const size_t input_len,   // NOLINT(bugprone-easily-swappable-p
     split_data.emplace( data.substr( i, write_size ) );
   }
 
-  ByteStream bs { capacity };
   string output_data;
   output_data.reserve( data.size() );
 
@@ -75,20 +77,36 @@ void speed_test( const size_t input_len,   // NOLINT(bugprone-easily-swappable-p
   fstream debug_output;
   debug_output.open( "/dev/tty" );
 
-  cout << "ByteStream with capacity=" << capacity << ", write_size=" << write_size << ", read_size=" << read_size
-       << " reached " << fixed << setprecision( 2 ) << gigabits_per_second << " Gbit/s.\n";
+  cout << description << " with capacity=" << capacity << ", write_size=" << write_size
+       << ", read_size=" << read_size << " reached " << fixed << setprecision( 2 ) << gigabits_per_second
+       << " Gbit/s.\n";
 
-  debug_output << "             ByteStream throughput: " << fixed << setprecision( 2 ) << gigabits_per_second
-               << " Gbit/s\n";
+  debug_output << "             " << description << " throughput: " << fixed << setprecision( 2 )
+               << gigabits_per_second << " Gbit/s\n";
 
   if ( gigabits_per_second < 0.1 ) {
-    throw runtime_error( "ByteStream did not meet minimum speed of 0.1 Gbit/s." );
+    throw runtime_error( description + " did not meet minimum speed of 0.1 Gbit/s." );
   }
 }
 
 void program_body()
 {
-  speed_test( 1e7, 32768, 789, 1500, 128 );
+  constexpr size_t capacity = 32768;
+
+  ByteStream ring { capacity };
+  speed_test( ring, "ByteStream", 1e7, capacity, 789, 1500, 128 );
+
+  StaticByteStream<capacity> fixed;
+  speed_test( fixed, "StaticByteStream", 1e7, capacity, 789, 1500, 128 );
+
+  ByteStream chunked = ByteStream::chunked( capacity );
+  speed_test( chunked, "Chunked ByteStream", 1e7, capacity, 789, 1500, 128 );
+
+  ByteStream mirrored = ByteStream::mirrored( capacity );
+  speed_test( mirrored, "Mirrored ByteStream", 1e7, capacity, 789, 1500, 128 );
+
+  ByteStream pooled = ByteStream::pooled( capacity, make_shared<BufferPool>() );
+  speed_test( pooled, "Pooled ByteStream", 1e7, capacity, 789, 1500, 128 );
 }
 
 int main()
@@ -0,0 +1,146 @@
+#include "byte_stream.hh"
+#include "byte_stream_test_harness.hh"
+#include "file_descriptor.hh"
+
+#include <array>
+#include <exception>
+#include <fcntl.h>
+#include <iostream>
+#include <unistd.h>
+#include <utility>
+
+using namespace std;
+
+pair<FileDescriptor, FileDescriptor> make_pipe()
+{
+  array<int, 2> fds {};
+  if ( pipe2( fds.data(), O_CLOEXEC ) < 0 ) {
+    throw runtime_error( "pipe2 failed" );
+  }
+  return { FileDescriptor { fds[0] }, FileDescriptor { fds[1] } };
+}
+
+struct PushFrom : public ExpectNumber<ByteStream, uint64_t>
+{
+  FileDescriptor& source_;
+
+  PushFrom( FileDescriptor& source, uint64_t expected ) : ExpectNumber( expected ), source_( source ) {}
+  std::string name() const override { return "push_from( pipe )"; }
+  uint64_t value( ByteStream& bs ) const override { return bs.writer().push_from( source_ ); }
+};
+
+struct PopTo : public ExpectNumber<ByteStream, uint64_t>
+{
+  FileDescriptor& sink_;
+
+  PopTo( FileDescriptor& sink, uint64_t expected ) : ExpectNumber( expected ), sink_( sink ) {}
+  std::string name() const override { return "pop_to( pipe )"; }
+  uint64_t value( ByteStream& bs ) const override { return bs.reader().pop_to( sink_ ); }
+};
+
+struct PipeContents : public Expectation<ByteStream>
+{
+  FileDescriptor& pipe_;
+  string expected_;
+
+  PipeContents( FileDescriptor& pipe, string expected ) : pipe_( pipe ), expected_( move( expected ) ) {}
+  std::string description() const override { return "pipe holds \"" + Printer::prettify( expected_ ) + "\""; }
+  void execute( ByteStream& /* unused */ ) const override
+  {
+    string all, chunk;
+    while ( all.size() < expected_.size() ) {
+      pipe_.read( chunk );
+      all += chunk;
+    }
+    if ( all != expected_ ) {
+      throw ExpectationViolation { "Expected \"" + Printer::prettify( expected_ ) + "\" in the pipe, but found \""
+                                   + Printer::prettify( all ) + "\"" };
+    }
+  }
+};
+
+int main()
+{
+  try {
+    {
+      // Transfers into and out of the memfd stop at its end, so a wrapped region takes two calls.
+      string data;
+      for ( unsigned i = 0; i < 5000; i++ ) {
+        data.push_back( static_cast<char>( 'a' + i % 26 ) );
+      }
+      auto [in_read, in_write] = make_pipe();
+      auto [out_read, out_write] = make_pipe();
+
+      ByteStreamTestHarness test { "splice-mirrored", "mirrored capacity=4096", ByteStream::mirrored( 4096 ) };
+      in_write.write( data.substr( 0, 3000 ) );
+      test.execute( PushFrom { in_read, 3000 } );
+      test.execute( BytesPushed { 3000 } );
+      test.execute( PopTo { out_write, 3000 } );
+      test.execute( PipeContents { out_read, data.substr( 0, 3000 ) } );
+      in_write.write( data.substr( 3000 ) );
+      test.execute( PushFrom { in_read, 1096 } );
+      test.execute( PushFrom { in_read, 904 } );
+      test.execute( BytesBuffered { 2000 } );
+      test.execute( PeekRegions { { data.substr( 3000 ) } } );
+      test.execute( PopTo { out_write, 1096 } );
+      test.execute( PopTo { out_write, 904 } );
+      test.execute( PipeContents { out_read, data.substr( 3000 ) } );
+      test.execute( BytesPopped { 5000 } );
+      test.execute( PopTo { out_write, 0 } );
+    }
+
+    {
+      auto [in_read, in_write] = make_pipe();
+      auto [out_read, out_write] = make_pipe();
+
+      ByteStreamTestHarness test { "splice-mirrored-full", "mirrored capacity=10", ByteStream::mirrored( 10 ) };
+      in_write.write( "0123456789abcdef" );
+      test.execute( PushFrom { in_read, 10 } );
+      test.execute( AvailableCapacity { 0 } );
+      test.execute( PushFrom { in_read, 0 } );
+      test.execute( Pop { 4 } );
+      test.execute( PushFrom { in_read, 4 } );
+      test.execute( Close {} );
+      test.execute( PushFrom { in_read, 0 } );
+      test.execute( PopTo { out_write, 10 } );
+      test.execute( PipeContents { out_read, "456789abcd" } );
+      test.execute( IsFinished { true } );
+    }
+
+    {
+      // Other backends copy once through reserve() and writev().
+      auto [in_read, in_write] = make_pipe();
+      auto [out_read, out_write] = make_pipe();
+
+      ByteStreamTestHarness test { "splice-fallback", "ring capacity=16", ByteStream { 16 } };
+      in_write.write( "hello world, this is a pipe" );
+      test.execute( PushFrom { in_read, 16 } );
+      test.execute( Pop { 6 } );
+      test.execute( PushFrom { in_read, 6 } );
+      test.execute( PushFrom { in_read, 0 } );
+      test.execute( PopTo { out_write, 16 } );
+      test.execute( PipeContents { out_read, "world, this is a" } );
+      test.execute( PushFrom { in_read, 5 } );
+      test.execute( PopTo { out_write, 5 } );
+      test.execute( PipeContents { out_read, " pipe" } );
+    }
+
+    {
+      auto [in_read, in_write] = make_pipe();
+      auto [out_read, out_write] = make_pipe();
+
+      ByteStreamTestHarness test { "splice-fallback-chunked", "chunked capacity=8", ByteStream::chunked( 8 ) };
+      in_write.write( "abcdefghij" );
+      test.execute( PushFrom { in_read, 8 } );
+      test.execute( Pop { 3 } );
+      test.execute( PushFrom { in_read, 2 } );
+      test.execute( PopTo { out_write, 7 } );
+      test.execute( PipeContents { out_read, "defghij" } );
+    }
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
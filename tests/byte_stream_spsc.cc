@@ -0,0 +1,225 @@
+#include "common.hh"
+#include "spsc_byte_stream.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <string>
+
+using namespace std;
+
+// An SPSCByteStream can be neither copied nor moved, so the harness holds it on the heap.
+struct SPSCStream
+{
+  unique_ptr<SPSCByteStream> stream_;
+
+  explicit SPSCStream( uint64_t capacity ) : stream_( make_unique<SPSCByteStream>( capacity ) ) {}
+  SPSCWriter& writer() { return stream_->writer(); }
+  SPSCReader& reader() { return stream_->reader(); }
+};
+
+class SPSCTestHarness : public TestHarness<SPSCStream>
+{
+public:
+  SPSCTestHarness( string test_name, uint64_t capacity )
+    : TestHarness( move( test_name ), "capacity=" + to_string( capacity ), SPSCStream { capacity } )
+  {}
+};
+
+/* actions */
+
+struct Push : public Action<SPSCStream>
+{
+  string data_;
+
+  explicit Push( string data ) : data_( move( data ) ) {}
+  string description() const override { return "push \"" + Printer::prettify( data_ ) + "\" to the stream"; }
+  void execute( SPSCStream& s ) const override { s.writer().push( data_ ); }
+};
+
+struct Close : public Action<SPSCStream>
+{
+  string description() const override { return "close"; }
+  void execute( SPSCStream& s ) const override { s.writer().close(); }
+};
+
+struct SetError : public Action<SPSCStream>
+{
+  string description() const override { return "set_error"; }
+  void execute( SPSCStream& s ) const override { s.writer().set_error(); }
+};
+
+struct Pop : public Action<SPSCStream>
+{
+  size_t len_;
+
+  explicit Pop( size_t len ) : len_( len ) {}
+  string description() const override { return "pop( " + to_string( len_ ) + " )"; }
+  void execute( SPSCStream& s ) const override { s.reader().pop( len_ ); }
+};
+
+/* expectations */
+
+struct PeekOnce : public Expectation<SPSCStream>
+{
+  string output_;
+
+  explicit PeekOnce( string output ) : output_( move( output ) ) {}
+  string description() const override { return "peek() gives exactly \"" + Printer::prettify( output_ ) + "\""; }
+  void execute( SPSCStream& s ) const override
+  {
+    const auto peeked = s.reader().peek();
+    if ( peeked != output_ ) {
+      throw ExpectationViolation { "Expected exactly \"" + Printer::prettify( output_ ) + "\" at front of stream, "
+                                   + "but found \"" + Printer::prettify( peeked ) + "\"" };
+    }
+  }
+};
+
+struct IsClosed : public ExpectBool<SPSCStream>
+{
+  using ExpectBool::ExpectBool;
+  string name() const override { return "is_closed"; }
+  bool value( SPSCStream& s ) const override { return s.writer().is_closed(); }
+};
+
+struct IsFinished : public ExpectBool<SPSCStream>
+{
+  using ExpectBool::ExpectBool;
+  string name() const override { return "is_finished"; }
+  bool value( SPSCStream& s ) const override { return s.reader().is_finished(); }
+};
+
+struct HasError : public ExpectBool<SPSCStream>
+{
+  using ExpectBool::ExpectBool;
+  string name() const override { return "has_error"; }
+  bool value( SPSCStream& s ) const override { return s.reader().has_error(); }
+};
+
+struct BytesBuffered : public ExpectNumber<SPSCStream, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  string name() const override { return "bytes_buffered"; }
+  uint64_t value( SPSCStream& s ) const override { return s.reader().bytes_buffered(); }
+};
+
+struct AvailableCapacity : public ExpectNumber<SPSCStream, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  string name() const override { return "available_capacity"; }
+  uint64_t value( SPSCStream& s ) const override { return s.writer().available_capacity(); }
+};
+
+struct BytesPushed : public ExpectNumber<SPSCStream, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  string name() const override { return "bytes_pushed"; }
+  uint64_t value( SPSCStream& s ) const override { return s.writer().bytes_pushed(); }
+};
+
+struct BytesPopped : public ExpectNumber<SPSCStream, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  string name() const override { return "bytes_popped"; }
+  uint64_t value( SPSCStream& s ) const override { return s.reader().bytes_popped(); }
+};
+
+struct ReadAll : public Expectation<SPSCStream>
+{
+  string output_;
+
+  explicit ReadAll( string output ) : output_( move( output ) ) {}
+  string description() const override
+  {
+    return "reading \"" + Printer::prettify( output_ ) + "\" leaves buffer empty";
+  }
+  void execute( SPSCStream& s ) const override
+  {
+    string got;
+    read( s.reader(), output_.size() + 1, got );
+    if ( got != output_ ) {
+      throw ExpectationViolation { "Expected to read \"" + Printer::prettify( output_ ) + "\", but found \""
+                                   + Printer::prettify( got ) + "\"" };
+    }
+    if ( s.reader().bytes_buffered() != 0 ) {
+      throw ExpectationViolation { "bytes_buffered", uint64_t { 0 }, s.reader().bytes_buffered() };
+    }
+  }
+};
+
+int main()
+{
+  try {
+    {
+      SPSCTestHarness test { "spsc-close", 15 };
+      test.execute( IsClosed { false } );
+      test.execute( IsFinished { false } );
+      test.execute( Push { "cat" } );
+      test.execute( Close {} );
+      test.execute( IsClosed { true } );
+      test.execute( IsFinished { false } );
+      test.execute( Push { "dog" } );
+      test.execute( BytesPushed { 3 } );
+      test.execute( ReadAll { "cat" } );
+      test.execute( IsFinished { true } );
+      test.execute( HasError { false } );
+    }
+
+    {
+      SPSCTestHarness test { "spsc-set-error", 15 };
+      test.execute( HasError { false } );
+      test.execute( SetError {} );
+      test.execute( HasError { true } );
+      test.execute( IsClosed { false } );
+    }
+
+    {
+      SPSCTestHarness test { "spsc-full-and-partial-push", 4 };
+      test.execute( AvailableCapacity { 4 } );
+      test.execute( Push { "ab" } );
+      test.execute( AvailableCapacity { 2 } );
+      test.execute( Push { "cdef" } );
+      test.execute( BytesPushed { 4 } );
+      test.execute( BytesBuffered { 4 } );
+      test.execute( AvailableCapacity { 0 } );
+      test.execute( Push { "g" } );
+      test.execute( BytesPushed { 4 } );
+      test.execute( PeekOnce { "abcd" } );
+      test.execute( Pop { 1 } );
+      test.execute( AvailableCapacity { 1 } );
+      test.execute( Push { "gh" } );
+      test.execute( BytesPushed { 5 } );
+      test.execute( AvailableCapacity { 0 } );
+    }
+
+    {
+      SPSCTestHarness test { "spsc-wraparound", 4 };
+      test.execute( Push { "abc" } );
+      test.execute( Pop { 2 } );
+      test.execute( Push { "def" } );
+      test.execute( BytesBuffered { 4 } );
+      // The bytes that wrapped around come in a second peek.
+      test.execute( PeekOnce { "cd" } );
+      test.execute( Pop { 2 } );
+      test.execute( PeekOnce { "ef" } );
+      test.execute( Push { "gh" } );
+      test.execute( Pop { 100 } );
+      test.execute( BytesPopped { 8 } );
+      test.execute( BytesBuffered { 0 } );
+      test.execute( Push { "ijklmn" } );
+      test.execute( Close {} );
+      test.execute( ReadAll { "ijkl" } );
+      test.execute( IsFinished { true } );
+      test.execute( BytesPushed { 12 } );
+      test.execute( BytesPopped { 12 } );
+    }
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,125 @@
+#include "spsc_byte_stream.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <queue>
+#include <random>
+#include <thread>
+
+using namespace std;
+using namespace std::chrono;
+
+// The two threads compete with whatever else runs on the machine (e.g. tests in parallel), so a single run can
+// come out far slower than the stream is: keep the best of a few.
+static constexpr int REPETITIONS = 3;
+
+// Stream `data` through a fresh SPSCByteStream across two threads, and return the throughput in Gbit/s
+double transfer( const string& data, const size_t capacity, const size_t write_size, const size_t read_size )
+{
+  // Split the data into segments before writing
+  queue<string> split_data;
+  for ( size_t i = 0; i < data.size(); i += write_size ) {
+    split_data.emplace( data.substr( i, write_size ) );
+  }
+
+  SPSCByteStream bs { capacity };
+  string output_data;
+  output_data.reserve( data.size() );
+
+  const auto start_time = steady_clock::now();
+
+  // The producer thread owns the Writer...
+  thread producer { [&bs, &split_data] {
+    while ( not split_data.empty() ) {
+      if ( split_data.front().size() <= bs.writer().available_capacity() ) {
+        bs.writer().push( move( split_data.front() ) );
+        split_data.pop();
+      } else {
+        this_thread::yield(); // don't spin away the reader's time slice when the cores are oversubscribed
+      }
+    }
+    bs.writer().close();
+  } };
+
+  // ... while this thread owns the Reader.
+  while ( not bs.reader().is_finished() ) {
+    auto peeked = bs.reader().peek().substr( 0, read_size );
+    if ( peeked.empty() ) {
+      this_thread::yield();
+      continue;
+    }
+    output_data += peeked;
+    bs.reader().pop( peeked.size() );
+  }
+
+  producer.join();
+  const auto stop_time = steady_clock::now();
+
+  if ( data != output_data ) {
+    throw runtime_error( "Mismatch between data written and read" );
+  }
+
+  auto test_duration = duration_cast<duration<double>>( stop_time - start_time );
+  auto bytes_per_second = static_cast<double>( data.size() ) / test_duration.count();
+  auto bits_per_second = 8 * bytes_per_second;
+  return bits_per_second / 1e9;
+}
+
+void speed_test( const size_t input_len,   // NOLINT(bugprone-easily-swappable-parameters)
+                 const size_t capacity,    // NOLINT(bugprone-easily-swappable-parameters)
+                 const size_t random_seed, // NOLINT(bugprone-easily-swappable-parameters)
+                 const size_t write_size,  // NOLINT(bugprone-easily-swappable-parameters)
+                 const size_t read_size )  // NOLINT(bugprone-easily-swappable-parameters)
+{
+  // Generate the data to be written
+  const string data = [&random_seed, &input_len] {
+    default_random_engine rd { random_seed };
+    uniform_int_distribution<char> ud;
+    string ret;
+    for ( size_t i = 0; i < input_len; ++i ) {
+      ret += ud( rd );
+    }
+    return ret;
+  }();
+
+  double gigabits_per_second = 0;
+  for ( int i = 0; i < REPETITIONS; i++ ) {
+    gigabits_per_second = max( gigabits_per_second, transfer( data, capacity, write_size, read_size ) );
+  }
+
+  fstream debug_output;
+  debug_output.open( "/dev/tty" );
+
+  cout << "SPSCByteStream with capacity=" << capacity << ", write_size=" << write_size
+       << ", read_size=" << read_size << " reached " << fixed << setprecision( 2 ) << gigabits_per_second
+       << " Gbit/s across two threads (best of " << REPETITIONS << " runs).\n";
+
+  debug_output << "        SPSCByteStream throughput: " << fixed << setprecision( 2 ) << gigabits_per_second
+               << " Gbit/s\n";
+
+  if ( gigabits_per_second < 0.1 ) {
+    throw runtime_error( "SPSCByteStream did not meet minimum speed of 0.1 Gbit/s." );
+  }
+}
+
+void program_body()
+{
+  speed_test( 1e7, 32768, 789, 1500, 128 );
+  speed_test( 1e8, 65536, 789, 16384, 65536 );
+}
+
+int main()
+{
+  try {
+    program_body();
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,56 @@
+#include "byte_stream_test_harness.hh"
+#include "reassembler.hh"
+#include "static_byte_stream.hh"
+
+#include <exception>
+#include <iostream>
+
+using namespace std;
+
+int main()
+{
+  try {
+    {
+      ByteStreamTestHarness test { "static-wraparound", "StaticByteStream<8>", StaticByteStream<8> {} };
+      test.execute( AvailableCapacity { 8 } );
+      test.execute( Push { "abcdef" } );
+      test.execute( Pop { 5 } );
+      test.execute( Push { "ghijklmn" } );
+      test.execute( BytesPushed { 13 } );
+      test.execute( AvailableCapacity { 0 } );
+      test.execute( ReserveSize { 4, 0 } );
+      test.execute( PeekOnce { "fgh" } );
+      test.execute( PeekRegions { { "fgh", "ijklm" } } );
+      test.execute( Pop { 3 } );
+      test.execute( ReserveSize { 4, 3 } );
+      test.execute( ReserveCommit { "opqr" } );
+      test.execute( PeekOnce { "ijklmopq" } );
+      test.execute( Close {} );
+      test.execute( ReadAll { "ijklmopq" } );
+      test.execute( IsFinished { true } );
+    }
+
+    {
+      // read() and the Reassembler take the stream's Reader and Writer as-is.
+      StaticByteStream<16> stream;
+      Reassembler reassembler;
+      reassembler.insert( 3, "defg", true, stream.writer() );
+      reassembler.insert( 0, "abc", false, stream.writer() );
+
+      const StaticByteStream<16> copy = stream;
+      string out;
+      read( stream.reader(), 16, out );
+      if ( out != "abcdefg" or not stream.reader().is_finished() ) {
+        throw runtime_error( "StaticByteStream did not carry the reassembled bytes" );
+      }
+      if ( copy.reader().bytes_buffered() != 7 or copy.reader().peek() != "abcdefg" ) {
+        throw runtime_error( "a copy of a StaticByteStream should keep its own bytes" );
+      }
+    }
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
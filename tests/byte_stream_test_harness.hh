@@ -3,6 +3,7 @@
 #include "byte_stream.hh"
 #include "common.hh"
 
+#include <algorithm>
 #include <concepts>
 #include <optional>
 #include <utility>
@@ -20,6 +21,10 @@ public:
     : TestHarness( move( test_name ), "capacity=" + std::to_string( capacity ), ByteStream { capacity } )
   {}
 
+  ByteStreamTestHarness( std::string test_name, std::string_view desc, ByteStream stream )
+    : TestHarness( move( test_name ), desc, std::move( stream ) )
+  {}
+
   size_t peek_size() { return object().reader().peek().size(); }
 };
 
@@ -34,6 +39,26 @@ struct Push : public Action<ByteStream>
   void execute( ByteStream& bs ) const override { bs.writer().push( data_ ); }
 };
 
+// Write `data` into the span from reserve( data.size() ) and commit as much of it as fit.
+struct ReserveCommit : public Action<ByteStream>
+{
+  std::string data_;
+
+  explicit ReserveCommit( std::string data ) : data_( move( data ) ) {}
+  std::string description() const override
+  {
+    return "reserve( " + std::to_string( data_.size() ) + " ), fill with \"" + Printer::prettify( data_ )
+           + "\" and commit";
+  }
+  void execute( ByteStream& bs ) const override
+  {
+    const auto span = bs.writer().reserve( data_.size() );
+    const auto len = std::min( span.size(), data_.size() );
+    std::copy_n( data_.begin(), len, span.begin() );
+    bs.writer().commit( len );
+  }
+};
+
 struct Close : public Action<ByteStream>
 {
   std::string description() const override { return "close"; }
@@ -107,6 +132,59 @@ struct PeekOnce : public Peek
   }
 };
 
+struct PeekRegions : public Expectation<ByteStream>
+{
+  std::vector<std::string> regions_;
+
+  explicit PeekRegions( std::vector<std::string> regions ) : regions_( move( regions ) ) {}
+
+  std::string description() const override
+  {
+    std::string desc = "peek( regions ) gives";
+    for ( const auto& region : regions_ ) {
+      desc += " \"" + Printer::prettify( region ) + "\"";
+    }
+    return desc;
+  }
+
+  void execute( ByteStream& bs ) const override
+  {
+    std::vector<std::string_view> got;
+    bs.reader().peek( got );
+    if ( got.size() != regions_.size() ) {
+      throw ExpectationViolation( "number of regions", regions_.size(), got.size() );
+    }
+    for ( size_t i = 0; i < got.size(); ++i ) {
+      if ( got[i] != regions_[i] ) {
+        throw ExpectationViolation { "Expected region " + std::to_string( i ) + " to be \""
+                                     + Printer::prettify( regions_[i] ) + "\", but found \""
+                                     + Printer::prettify( got[i] ) + "\"" };
+      }
+    }
+  }
+};
+
+struct ReserveSize : public Expectation<ByteStream>
+{
+  uint64_t len_;
+  uint64_t size_;
+
+  ReserveSize( uint64_t len, uint64_t size ) : len_( len ), size_( size ) {}
+
+  std::string description() const override
+  {
+    return "reserve( " + std::to_string( len_ ) + " ) gives a span of " + std::to_string( size_ ) + " bytes";
+  }
+
+  void execute( ByteStream& bs ) const override
+  {
+    const auto span = bs.writer().reserve( len_ );
+    if ( span.size() != size_ ) {
+      throw ExpectationViolation( "reserved span size", size_, static_cast<uint64_t>( span.size() ) );
+    }
+  }
+};
+
 struct IsClosed : public ExpectBool<ByteStream>
 {
   using ExpectBool::ExpectBool;
@@ -54,9 +54,3 @@ inline bool operator!=( Wrap32 a, Wrap32 b )
 {
   return not( a == b );
 }
-
-inline int64_t operator-( Wrap32 a, Wrap32 b )
-{
-  return static_cast<int64_t>( minnow_conversions::DebugWrap32 { a }.debug_get_raw_value() )
-         - static_cast<int64_t>( minnow_conversions::DebugWrap32 { b }.debug_get_raw_value() );
-}
@@ -0,0 +1,96 @@
+#include "reassembler_test_harness.hh"
+
+#include <exception>
+#include <iostream>
+#include <sstream>
+
+using namespace std;
+
+// Each batch takes slices of a Buffer holding the whole stream, so a slice's offset is also its stream index.
+struct InsertBatch : public Action<StreamAndReassembler>
+{
+  vector<Reassembler::Segment> segments_;
+
+  InsertBatch( const Buffer& stream, const vector<pair<uint64_t, uint64_t>>& ranges, bool ends_stream = false )
+    : segments_()
+  {
+    for ( const auto& [begin, end] : ranges ) {
+      segments_.push_back( { begin, { stream, begin, end - begin }, ends_stream && end == stream.size() } );
+    }
+  }
+
+  std::string description() const override
+  {
+    ostringstream ss;
+    ss << "insert batch of";
+    for ( const auto& segment : segments_ ) {
+      ss << " \"" << Printer::prettify( string( segment.data.view() ) ) << "\" @ " << segment.first_index;
+    }
+    return ss.str();
+  }
+
+  void execute( StreamAndReassembler& sr ) const override
+  {
+    auto segments = segments_;
+    sr.second.insert_batch( segments, sr.first.writer() );
+  }
+};
+
+int main()
+{
+  try {
+    const Buffer stream { "0123456789abcdefghij" };
+
+    for ( const auto& [engine, reassembler] :
+          { pair { "intervals", Reassembler {} }, pair { "windowed", Reassembler::windowed() } } ) {
+      {
+        ReassemblerTestHarness test { string( "batch in order, " ) + engine, 1000, reassembler };
+
+        test.execute( InsertBatch { stream, { { 0, 4 }, { 4, 8 }, { 8, 12 } } } );
+        test.execute( BytesPending { 0 } );
+        test.execute( ReadAll( "0123456789ab" ) );
+      }
+
+      {
+        ReassemblerTestHarness test { string( "batch reordered with overlaps, " ) + engine, 1000, reassembler };
+
+        test.execute(
+          InsertBatch { stream, { { 10, 14 }, { 4, 8 }, { 6, 9 }, { 0, 4 }, { 16, 20 }, { 11, 13 } } } );
+        test.execute( BytesPending { 8 } );
+        test.execute( ReadAll( "012345678" ) );
+        test.execute( InsertBatch { stream, { { 14, 16 }, { 9, 10 } } } );
+        test.execute( BytesPending { 0 } );
+        test.execute( ReadAll( "9abcdefghij" ) );
+      }
+
+      {
+        ReassemblerTestHarness test { string( "batch fills held gap, " ) + engine, 1000, reassembler };
+
+        test.execute( Insert { "abc", 10 } );
+        test.execute( InsertBatch { stream, { { 5, 11 }, { 13, 15 }, { 0, 5 } } } );
+        test.execute( BytesPending { 0 } );
+        test.execute( ReadAll( "0123456789abcde" ) );
+      }
+
+      {
+        ReassemblerTestHarness test { string( "batch beyond capacity, " ) + engine, 8, reassembler };
+
+        test.execute( InsertBatch { stream, { { 12, 20 }, { 6, 12 }, { 2, 6 } }, true } );
+        test.execute( BytesPending { 6 } );
+        test.execute( InsertBatch { stream, { { 0, 2 } } } );
+        test.execute( ReadAll( "01234567" ) );
+        test.execute( IsFinished { false } );
+        test.execute( InsertBatch { stream, { { 8, 14 }, { 14, 20 } }, true } );
+        test.execute( ReadAll( "89abcdef" ) );
+        test.execute( InsertBatch { stream, { { 16, 20 } }, true } );
+        test.execute( ReadAll( "ghij" ) );
+        test.execute( IsFinished { true } );
+      }
+    }
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
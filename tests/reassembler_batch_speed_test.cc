@@ -0,0 +1,123 @@
+#include "reassembler.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace std;
+using namespace std::chrono;
+
+/*
+ * Replays a stream as bursts of `burst_size` segments, each burst shuffled (as after GRO on a reordering path),
+ * into a Reassembler either one insert() per segment or one insert_batch() per burst.
+ */
+void speed_test( Reassembler reassembler,
+                 const string& description,
+                 const bool batched,
+                 const size_t burst_size,   // NOLINT(bugprone-easily-swappable-parameters)
+                 const size_t num_bursts,   // NOLINT(bugprone-easily-swappable-parameters)
+                 const size_t segment_size, // NOLINT(bugprone-easily-swappable-parameters)
+                 const size_t random_seed ) // NOLINT(bugprone-easily-swappable-parameters)
+{
+  default_random_engine rd { random_seed };
+
+  // Generate the data to be written
+  const size_t stream_size = burst_size * num_bursts * segment_size;
+  const Buffer data = [&] {
+    uniform_int_distribution<char> ud;
+    string ret;
+    for ( size_t i = 0; i < stream_size; ++i ) {
+      ret += ud( rd );
+    }
+    return ret;
+  }();
+
+  // Split the data into shuffled bursts of segments
+  vector<vector<Reassembler::Segment>> bursts( num_bursts );
+  for ( size_t i = 0; i < num_bursts; ++i ) {
+    for ( size_t j = 0; j < burst_size; ++j ) {
+      const uint64_t first_index = ( i * burst_size + j ) * segment_size;
+      bursts[i].push_back(
+        { first_index, { data, first_index, segment_size }, first_index + segment_size == stream_size } );
+    }
+    shuffle( bursts[i].begin(), bursts[i].end(), rd );
+  }
+
+  ByteStream stream { burst_size * segment_size };
+
+  string output_data;
+  output_data.reserve( stream_size );
+
+  const auto start_time = steady_clock::now();
+  for ( auto& burst : bursts ) {
+    if ( batched ) {
+      reassembler.insert_batch( burst, stream.writer() );
+    } else {
+      for ( auto& segment : burst ) {
+        reassembler.insert(
+          segment.first_index, std::move( segment.data ), segment.is_last_substring, stream.writer() );
+      }
+    }
+
+    while ( stream.reader().bytes_buffered() ) {
+      output_data += stream.reader().peek();
+      stream.reader().pop( output_data.size() - stream.reader().bytes_popped() );
+    }
+  }
+  const auto stop_time = steady_clock::now();
+
+  if ( not stream.reader().is_finished() ) {
+    throw runtime_error( "Reassembler did not close ByteStream when finished" );
+  }
+
+  if ( string_view( data ) != output_data ) {
+    throw runtime_error( "Mismatch between data written and read" );
+  }
+
+  auto test_duration = duration_cast<duration<double>>( stop_time - start_time );
+  auto bytes_per_second = static_cast<double>( stream_size ) / test_duration.count();
+  auto bits_per_second = 8 * bytes_per_second;
+  auto gigabits_per_second = bits_per_second / 1e9;
+
+  fstream debug_output;
+  debug_output.open( "/dev/tty" );
+
+  cout << description << " Reassembler, bursts of " << burst_size
+       << ( batched ? " via insert_batch()" : " via insert()" ) << ", reached " << fixed << setprecision( 2 )
+       << gigabits_per_second << " Gbit/s.\n";
+
+  debug_output << "             Reassembler burst throughput (" << description << ", " << burst_size
+               << ( batched ? ", batched" : "" ) << "): " << fixed << setprecision( 2 ) << gigabits_per_second
+               << " Gbit/s\n";
+
+  if ( gigabits_per_second < 0.1 ) {
+    throw runtime_error( "Reassembler did not meet minimum speed of 0.1 Gbit/s." );
+  }
+}
+
+void program_body()
+{
+  for ( const size_t burst_size : { 16, 64 } ) {
+    for ( const bool batched : { false, true } ) {
+      speed_test( Reassembler {}, "Interval", batched, burst_size, 4096 / burst_size, 1460, 1370 );
+      speed_test( Reassembler::windowed(), "Windowed", batched, burst_size, 4096 / burst_size, 1460, 1370 );
+    }
+  }
+}
+
+int main()
+{
+  try {
+    program_body();
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,117 @@
+#include "reassembler_test_harness.hh"
+
+#include <exception>
+#include <iostream>
+#include <memory>
+
+using namespace std;
+
+struct BudgetIs : public Expectation<StreamAndReassembler>
+{
+  shared_ptr<ReassemblyBudget> budget_;
+  uint64_t in_use_, pruned_bytes_, pruned_runs_;
+
+  BudgetIs( shared_ptr<ReassemblyBudget> budget,
+            uint64_t in_use,          // NOLINT(bugprone-easily-swappable-parameters)
+            uint64_t pruned_bytes,    // NOLINT(bugprone-easily-swappable-parameters)
+            uint64_t pruned_runs ) // NOLINT(bugprone-easily-swappable-parameters)
+    : budget_( move( budget ) )
+    , in_use_( in_use )
+    , pruned_bytes_( pruned_bytes )
+    , pruned_runs_( pruned_runs )
+  {}
+
+  std::string description() const override
+  {
+    return "budget has " + to_string( in_use_ ) + " bytes in use, pruned " + to_string( pruned_bytes_ )
+           + " bytes in " + to_string( pruned_runs_ ) + " runs";
+  }
+
+  void execute( StreamAndReassembler& /* unused */ ) const override
+  {
+    if ( budget_->bytes_in_use() != in_use_ ) {
+      throw ExpectationViolation { "bytes_in_use", in_use_, budget_->bytes_in_use() };
+    }
+    if ( budget_->pruned_bytes() != pruned_bytes_ ) {
+      throw ExpectationViolation { "pruned_bytes", pruned_bytes_, budget_->pruned_bytes() };
+    }
+    if ( budget_->pruned_runs() != pruned_runs_ ) {
+      throw ExpectationViolation { "pruned_runs", pruned_runs_, budget_->pruned_runs() };
+    }
+  }
+};
+
+int main()
+{
+  try {
+    for ( const bool windowed : { false, true } ) {
+      const string engine = windowed ? "windowed" : "intervals";
+      auto budget = make_shared<ReassemblyBudget>( 10 );
+      const auto make_reassembler
+        = [&] { return windowed ? Reassembler::windowed( budget ) : Reassembler { budget }; };
+
+      {
+        ReassemblerTestHarness a { "budget shared by two reassemblers (A), " + engine, 1000, make_reassembler() };
+        ReassemblerTestHarness b { "budget shared by two reassemblers (B), " + engine, 1000, make_reassembler() };
+
+        a.execute( Insert { "bcdef", 1 } );
+        b.execute( Insert { "bcdef", 1 } );
+        b.execute( BudgetIs { budget, 10, 0, 0 } );
+
+        // Over budget: B drops its own highest-offset data first, here all of the new segment.
+        b.execute( Insert { "xyz", 10 } );
+        b.execute( BytesPending { 5 } );
+        b.execute( HeldIntervals { { { 1, 6 } } } );
+        b.execute( BudgetIs { budget, 10, 3, 1 } );
+
+        a.execute( Insert { "gh", 6 } );
+        a.execute( BytesPending { 5 } );
+        a.execute( HeldIntervals { { { 1, 6 } } } );
+        a.execute( BudgetIs { budget, 10, 5, 2 } );
+
+        a.execute( Insert { "a", 0 } );
+        a.execute( ReadAll( "abcdef" ) );
+        a.execute( BudgetIs { budget, 5, 5, 2 } );
+        b.execute( Insert { "xyz", 10 } );
+        b.execute( BytesPending { 8 } );
+      }
+
+      {
+        // Only the excess goes, even when it is part of a larger segment.
+        ReassemblerTestHarness test { "budget trims to the excess, " + engine, 1000, make_reassembler() };
+        test.execute( Insert { "bcdefghi", 1 } );
+        test.execute( Insert { "wxyz", 20 } );
+        test.execute( BytesPending { 10 } );
+        test.execute( HeldIntervals { { { 1, 9 }, { 20, 22 } } } );
+        test.execute( BudgetIs { budget, 10, 7, 3 } );
+        test.execute( Insert { "a", 0 } );
+        test.execute( ReadAll( "abcdefghi" ) );
+        test.execute( BytesPending { 2 } );
+      }
+
+      if ( budget->bytes_in_use() != 0 ) {
+        throw runtime_error( "destroyed Reassemblers did not release their share of the budget" );
+      }
+    }
+
+    {
+      // A flood of one-byte holes never holds more than the budget, and keeps the lowest offsets.
+      auto budget = make_shared<ReassemblyBudget>( 100 );
+      ReassemblerTestHarness test { "budget under a flood of holes", 10000, Reassembler { budget } };
+      for ( uint64_t i = 0; i < 1000; i++ ) {
+        test.execute( Insert { "x", 2 * i + 1 } );
+      }
+      test.execute( BytesPending { 100 } );
+      test.execute( HeldIntervals { { { 1, 2 }, { 3, 4 } }, 2 } );
+      test.execute( BudgetIs { budget, 100, 900, 900 } );
+      if ( budget->peak_bytes_in_use() != 100 ) {
+        throw runtime_error( "budget exceeded its limit" );
+      }
+    }
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -272,6 +272,25 @@ int main()
       test.execute( BytesPushed( 5 ) );
       test.execute( BytesPending( 0 ) );
     }
+
+    {
+      // Touching and overlapping unassembled sections, merged while pending
+      const size_t cap = { 1000 };
+      ReassemblerTestHarness test { "merging unassembled sections", cap };
+
+      test.execute( Insert { "c", 2 } );
+      test.execute( Insert { "gh", 6 } );
+      test.execute( Insert { "e", 4 } );
+      test.execute( Insert { "d", 3 } );
+      test.execute( BytesPending( 5 ) );
+      test.execute( Insert { "bcdefg", 1 } );
+      test.execute( BytesPending( 7 ) );
+      test.execute( ReadAll( "" ) );
+
+      test.execute( Insert { "ab", 0 } );
+      test.execute( ReadAll( "abcdefgh" ) );
+      test.execute( BytesPending( 0 ) );
+    }
   } catch ( const exception& e ) {
     cerr << "Exception: " << e.what() << endl;
     return EXIT_FAILURE;
@@ -0,0 +1,260 @@
+#include "reassembler.hh"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string_view>
+#include <vector>
+
+using namespace std;
+using namespace std::chrono;
+
+/*
+ * Benchmarks both Reassembler engines over a sweep of arrival patterns and capacities, and prints one
+ * machine-readable row per run: CSV by default, or a JSON array with --json.
+ *
+ * Every pattern delivers the whole stream, but only ever sends bytes inside the current window (the reader
+ * drains the stream after each insert), so nothing is dropped for lack of capacity and runs are comparable.
+ *
+ * The per-segment cost may grow somewhat with the window (more held bytes, fewer cache hits), but an engine
+ * whose inserts are linear in what it holds shows up as a cost that grows with the capacity: each row reports
+ * its `slowdown`, the ratio of its cost per segment to that of the smallest capacity for the same engine and
+ * pattern. Each row is the fastest of REPETITIONS runs, so that a run slowed down by other work on the machine
+ * (e.g. tests running in parallel) doesn't skew the ratio.
+ */
+
+static constexpr array<size_t, 3> CAPACITIES { 4096, 65536, 1048576 };
+static constexpr int REPETITIONS = 5;
+
+struct Segment
+{
+  uint64_t first_index;
+  uint64_t length;
+};
+
+struct Result
+{
+  string engine;
+  string pattern;
+  size_t capacity;
+  size_t segments;
+  size_t bytes;
+  double gbit_per_s;
+  double ns_per_segment;
+  uint64_t peak_bytes_pending;
+  double slowdown = 1; // ns_per_segment relative to the smallest capacity
+};
+
+// Split [0, stream_size) into segments of `segment_size`, in order
+vector<Segment> split( size_t stream_size, size_t segment_size )
+{
+  vector<Segment> ret;
+  for ( uint64_t i = 0; i < stream_size; i += segment_size ) {
+    ret.push_back( { i, min<uint64_t>( segment_size, stream_size - i ) } );
+  }
+  return ret;
+}
+
+// Reorder the segments within consecutive groups that each span at most `window` bytes
+template<typename Reorder>
+void reorder_within_window( vector<Segment>& segments, size_t window, Reorder&& reorder )
+{
+  for ( auto group = segments.begin(); group != segments.end(); ) {
+    auto group_end = group;
+    const auto fits = [&]( const Segment& s ) { return s.first_index + s.length - group->first_index <= window; };
+    while ( group_end != segments.end() && fits( *group_end ) ) {
+      ++group_end;
+    }
+    reorder( group, group_end );
+    group = group_end;
+  }
+}
+
+vector<Segment> make_pattern( const string& pattern,
+                              size_t stream_size, // NOLINT(bugprone-easily-swappable-parameters)
+                              size_t capacity,    // NOLINT(bugprone-easily-swappable-parameters)
+                              default_random_engine& rd )
+{
+  const size_t segment_size = min<size_t>( 1000, capacity / 4 );
+  auto segments = split( stream_size, pattern == "tiny" ? 1 : segment_size );
+
+  if ( pattern == "permuted" || pattern == "tiny" ) {
+    reorder_within_window( segments, pattern == "tiny" ? 16 : capacity, [&]( auto begin, auto end ) {
+      shuffle( begin, end, rd );
+    } );
+  } else if ( pattern == "reverse" ) {
+    reorder_within_window( segments, capacity, []( auto begin, auto end ) { reverse( begin, end ); } );
+  } else if ( pattern == "duplicated" ) {
+    // Each segment arrives twice, plus a copy shifted back by half a segment (overlapping its predecessor)
+    vector<Segment> with_duplicates;
+    for ( const auto& segment : segments ) {
+      with_duplicates.push_back( segment );
+      with_duplicates.push_back( segment );
+      const uint64_t shifted = segment.first_index - min<uint64_t>( segment.first_index, segment_size / 2 );
+      with_duplicates.push_back( { shifted, segment.first_index + segment.length - shifted } );
+    }
+    segments = move( with_duplicates );
+    reorder_within_window( segments, capacity, [&]( auto begin, auto end ) { shuffle( begin, end, rd ); } );
+  } else if ( pattern == "sparse" ) {
+    // Far-ahead islands first (every eighth segment, from the far end of the window), then the holes in order
+    reorder_within_window( segments, capacity, []( auto begin, auto end ) {
+      vector<Segment> islands, holes;
+      for ( auto it = begin; it != end; ++it ) {
+        ( ( it - begin ) % 8 == 7 ? islands : holes ).push_back( *it );
+      }
+      reverse( islands.begin(), islands.end() );
+      copy( holes.begin(), holes.end(), copy( islands.begin(), islands.end(), begin ) );
+    } );
+  }
+  return segments;
+}
+
+Result run( Reassembler reassembler,
+            const string& engine,
+            const string& pattern,
+            const Buffer& data,
+            size_t capacity,
+            default_random_engine& rd )
+{
+  const auto segments = make_pattern( pattern, data.size(), capacity, rd );
+
+  ByteStream stream { capacity };
+  string output_data;
+  output_data.reserve( data.size() );
+  uint64_t peak_bytes_pending = 0;
+
+  const auto start_time = steady_clock::now();
+  for ( const auto& [first_index, length] : segments ) {
+    const bool is_last = first_index + length == data.size();
+    reassembler.insert( first_index, BufferSlice { data, first_index, length }, is_last, stream.writer() );
+    peak_bytes_pending = max( peak_bytes_pending, reassembler.bytes_pending() );
+
+    while ( stream.reader().bytes_buffered() ) {
+      output_data += stream.reader().peek();
+      stream.reader().pop( output_data.size() - stream.reader().bytes_popped() );
+    }
+  }
+  const auto stop_time = steady_clock::now();
+
+  if ( not stream.reader().is_finished() ) {
+    throw runtime_error( "Reassembler did not close ByteStream when finished (" + engine + ", " + pattern + ")" );
+  }
+  if ( string_view( data ) != output_data ) {
+    throw runtime_error( "Mismatch between data written and read (" + engine + ", " + pattern + ")" );
+  }
+
+  const double seconds = duration_cast<duration<double>>( stop_time - start_time ).count();
+  return { engine,
+           pattern,
+           capacity,
+           segments.size(),
+           data.size(),
+           8 * static_cast<double>( data.size() ) / seconds / 1e9,
+           seconds * 1e9 / static_cast<double>( segments.size() ),
+           peak_bytes_pending };
+}
+
+template<typename MakeReassembler>
+Result best_of( MakeReassembler&& make,
+                const string& engine,
+                const string& pattern,
+                const Buffer& data,
+                size_t capacity,
+                default_random_engine& rd )
+{
+  Result best = run( make(), engine, pattern, data, capacity, rd );
+  for ( int i = 1; i < REPETITIONS; i++ ) {
+    Result result = run( make(), engine, pattern, data, capacity, rd );
+    if ( result.ns_per_segment < best.ns_per_segment ) {
+      best = move( result );
+    }
+  }
+  return best;
+}
+
+void print_csv( const vector<Result>& results )
+{
+  cout << "engine,pattern,capacity,segments,bytes,gbit_per_s,ns_per_segment,peak_bytes_pending,slowdown\n";
+  for ( const auto& r : results ) {
+    cout << r.engine << "," << r.pattern << "," << r.capacity << "," << r.segments << "," << r.bytes << ","
+         << fixed << setprecision( 3 ) << r.gbit_per_s << "," << setprecision( 1 ) << r.ns_per_segment << ","
+         << r.peak_bytes_pending << "," << setprecision( 2 ) << r.slowdown << "\n";
+  }
+}
+
+void print_json( const vector<Result>& results )
+{
+  cout << "[\n";
+  for ( size_t i = 0; i < results.size(); i++ ) {
+    const auto& r = results[i];
+    cout << "  {\"engine\": \"" << r.engine << "\", \"pattern\": \"" << r.pattern << "\", \"capacity\": "
+         << r.capacity << ", \"segments\": " << r.segments << ", \"bytes\": " << r.bytes
+         << ", \"gbit_per_s\": " << fixed << setprecision( 3 ) << r.gbit_per_s
+         << ", \"ns_per_segment\": " << setprecision( 1 ) << r.ns_per_segment
+         << ", \"peak_bytes_pending\": " << r.peak_bytes_pending << ", \"slowdown\": " << setprecision( 2 )
+         << r.slowdown << "}" << ( i + 1 < results.size() ? "," : "" ) << "\n";
+  }
+  cout << "]\n";
+}
+
+// Fill in each result's slowdown relative to the smallest capacity
+void compute_slowdowns( vector<Result>& results )
+{
+  for ( auto& result : results ) {
+    for ( const auto& smallest : results ) {
+      if ( smallest.engine == result.engine and smallest.pattern == result.pattern
+           and smallest.capacity == CAPACITIES.front() ) {
+        result.slowdown = result.ns_per_segment / smallest.ns_per_segment;
+      }
+    }
+  }
+}
+
+void program_body( bool json )
+{
+  default_random_engine rd { 1370 };
+  const Buffer data = [&] {
+    uniform_int_distribution<char> ud;
+    string ret;
+    for ( size_t i = 0; i < 4 * 1024 * 1024; ++i ) {
+      ret += ud( rd );
+    }
+    return ret;
+  }();
+  const Buffer tiny_data { string( string_view( data ).substr( 0, 64 * 1024 ) ) };
+
+  vector<Result> results;
+  for ( const string pattern : { "in_order", "permuted", "reverse", "tiny", "duplicated", "sparse" } ) {
+    for ( const size_t capacity : CAPACITIES ) {
+      const Buffer& stream = pattern == "tiny" ? tiny_data : data;
+      const auto intervals = [] { return Reassembler {}; };
+      const auto windowed = [] { return Reassembler::windowed(); };
+      results.push_back( best_of( intervals, "intervals", pattern, stream, capacity, rd ) );
+      results.push_back( best_of( windowed, "windowed", pattern, stream, capacity, rd ) );
+    }
+  }
+
+  compute_slowdowns( results );
+  if ( json ) {
+    print_json( results );
+  } else {
+    print_csv( results );
+  }
+}
+
+int main( int argc, char* argv[] )
+{
+  try {
+    const vector<string_view> args( argv + 1, argv + argc );
+    program_body( ranges::find( args, "--json" ) != args.end() );
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
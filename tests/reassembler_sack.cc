@@ -0,0 +1,49 @@
+#include "reassembler_test_harness.hh"
+
+#include <exception>
+#include <iostream>
+
+using namespace std;
+
+int main()
+{
+  try {
+    for ( const auto& [engine, reassembler] :
+          { pair { "intervals", Reassembler {} }, pair { "windowed", Reassembler::windowed() } } ) {
+      {
+        ReassemblerTestHarness test { string( "held intervals, " ) + engine, 1000, reassembler };
+
+        test.execute( HeldIntervals { {} } );
+        test.execute( Insert { "cd", 2 } );
+        test.execute( Insert { "gh", 6 } );
+        test.execute( Insert { "k", 10 } );
+        test.execute( HeldIntervals { { { 2, 4 }, { 6, 8 }, { 10, 11 } } } );
+        test.execute( HeldIntervals { { { 2, 4 }, { 6, 8 } }, 2 } );
+        test.execute( Insert { "ef", 4 } );
+        test.execute( HeldIntervals { { { 2, 8 }, { 10, 11 } } } );
+        test.execute( Insert { "ab", 0 } );
+        test.execute( ReadAll( "abcdefgh" ) );
+        test.execute( HeldIntervals { { { 10, 11 } } } );
+        test.execute( Insert { "ij", 8 } );
+        test.execute( HeldIntervals { {} } );
+        test.execute( ReadAll( "ijk" ) );
+      }
+
+      {
+        // The window engine's ring is 64 bytes here, so the second interval straddles its end.
+        ReassemblerTestHarness test { string( "held intervals across wrap, " ) + engine, 100, reassembler };
+
+        test.execute( Insert { string( 50, 'x' ), 0 } );
+        test.execute( Insert { "0123", 52 } );
+        test.execute( Insert { "0123456789", 60 } );
+        test.execute( HeldIntervals { { { 52, 56 }, { 60, 70 } } } );
+        test.execute( BytesPending { 14 } );
+      }
+    }
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,82 @@
+#include "reassembler_test_harness.hh"
+
+#include <exception>
+#include <iostream>
+#include <sstream>
+
+using namespace std;
+
+struct InsertSlice : public Action<StreamAndReassembler>
+{
+  BufferSlice slice_;
+  bool is_last_substring_ {};
+
+  InsertSlice( const Buffer& buffer, uint64_t offset, uint64_t length, bool is_last_substring = false )
+    : slice_ { buffer, offset, length }, is_last_substring_( is_last_substring )
+  {}
+
+  std::string description() const override
+  {
+    ostringstream ss;
+    ss << "insert slice \"" << Printer::prettify( string( slice_.view() ) ) << "\" @ index " << slice_.offset;
+    if ( is_last_substring_ ) {
+      ss << " [last substring]";
+    }
+    return ss.str();
+  }
+
+  // The slices are taken from a Buffer holding the whole stream, so a slice's offset is also its stream index.
+  void execute( StreamAndReassembler& sr ) const override
+  {
+    sr.second.insert( slice_.offset, slice_, is_last_substring_, sr.first.writer() );
+  }
+};
+
+int main()
+{
+  try {
+    const Buffer stream { "0123456789abcdef" };
+
+    for ( const auto& [engine, reassembler] :
+          { pair { "intervals", Reassembler {} }, pair { "windowed", Reassembler::windowed() } } ) {
+      {
+        ReassemblerTestHarness test { string( "slices out of order, " ) + engine, 1000, reassembler };
+
+        test.execute( InsertSlice { stream, 8, 4 } );
+        test.execute( InsertSlice { stream, 2, 4 } );
+        test.execute( BytesPending { 8 } );
+        test.execute( InsertSlice { stream, 4, 6 } );
+        test.execute( BytesPending { 10 } );
+        test.execute( ReadAll( "" ) );
+        test.execute( InsertSlice { stream, 0, 3 } );
+        test.execute( BytesPending { 0 } );
+        test.execute( ReadAll( "0123456789ab" ) );
+        test.execute( InsertSlice { stream, 12, 4, true } );
+        test.execute( ReadAll( "cdef" ) );
+        test.execute( IsFinished { true } );
+      }
+
+      {
+        ReassemblerTestHarness test { string( "slices beyond capacity, " ) + engine, 4, reassembler };
+
+        test.execute( InsertSlice { stream, 2, 6 } );
+        test.execute( BytesPending { 2 } );
+        test.execute( InsertSlice { stream, 0, 16, true } );
+        test.execute( ReadAll( "0123" ) );
+        test.execute( IsFinished { false } );
+        test.execute( InsertSlice { stream, 4, 12, true } );
+        test.execute( ReadAll( "4567" ) );
+        test.execute( InsertSlice { stream, 8, 8, true } );
+        test.execute( ReadAll( "89ab" ) );
+        test.execute( InsertSlice { stream, 12, 4, true } );
+        test.execute( ReadAll( "cdef" ) );
+        test.execute( IsFinished { true } );
+      }
+    }
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
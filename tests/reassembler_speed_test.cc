@@ -13,7 +13,9 @@
 using namespace std;
 using namespace std::chrono;
 
-void speed_test( const size_t num_chunks,   // NOLINT(bugprone-easily-swappable-parameters)
+void speed_test( Reassembler reassembler,
+                 const string& description,
+                 const size_t num_chunks,   // NOLINT(bugprone-easily-swappable-parameters)
                  const size_t capacity,     // NOLINT(bugprone-easily-swappable-parameters)
                  const size_t random_seed ) // NOLINT(bugprone-easily-swappable-parameters)
 {
@@ -37,7 +39,6 @@ void speed_test( const size_t num_chunks,   // NOLINT(bugprone-easily-swappable-
   }
 
   ByteStream stream { capacity };
-  Reassembler reassembler;
 
   string output_data;
   output_data.reserve( data.size() );
@@ -72,11 +73,11 @@ void speed_test( const size_t num_chunks,   // NOLINT(bugprone-easily-swappable-
   fstream debug_output;
   debug_output.open( "/dev/tty" );
 
-  cout << "Reassembler to ByteStream with capacity=" << capacity << " reached " << fixed << setprecision( 2 )
-       << gigabits_per_second << " Gbit/s.\n";
+  cout << description << " Reassembler to ByteStream with capacity=" << capacity << " reached " << fixed
+       << setprecision( 2 ) << gigabits_per_second << " Gbit/s.\n";
 
-  debug_output << "             Reassembler throughput: " << fixed << setprecision( 2 ) << gigabits_per_second
-               << " Gbit/s\n";
+  debug_output << "             Reassembler throughput (" << description << "): " << fixed << setprecision( 2 )
+               << gigabits_per_second << " Gbit/s\n";
 
   if ( gigabits_per_second < 0.1 ) {
     throw runtime_error( "Reassembler did not meet minimum speed of 0.1 Gbit/s." );
@@ -85,7 +86,8 @@ void speed_test( const size_t num_chunks,   // NOLINT(bugprone-easily-swappable-
 
 void program_body()
 {
-  speed_test( 10000, 1500, 1370 );
+  speed_test( Reassembler {}, "Interval", 10000, 1500, 1370 );
+  speed_test( Reassembler::windowed(), "Windowed", 10000, 1500, 1370 );
 }
 
 int main()
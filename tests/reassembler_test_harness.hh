@@ -7,6 +7,7 @@
 #include <optional>
 #include <sstream>
 #include <utility>
+#include <vector>
 
 using StreamAndReassembler = std::pair<ByteStream, Reassembler>;
 
@@ -28,10 +29,10 @@ struct ReassemblerByteStreamTestStep : public TestStep<StreamAndReassembler>
 class ReassemblerTestHarness : public TestHarness<StreamAndReassembler>
 {
 public:
-  ReassemblerTestHarness( std::string test_name, uint64_t capacity )
+  ReassemblerTestHarness( std::string test_name, uint64_t capacity, Reassembler reassembler = {} )
     : TestHarness( move( test_name ),
                    "capacity=" + std::to_string( capacity ),
-                   { ByteStream { capacity }, Reassembler {} } )
+                   { ByteStream { capacity }, std::move( reassembler ) } )
   {}
 
   template<std::derived_from<TestStep<ByteStream>> T>
@@ -50,6 +51,44 @@ struct BytesPending : public ExpectNumber<StreamAndReassembler, uint64_t>
   uint64_t value( StreamAndReassembler& sr ) const override { return sr.second.bytes_pending(); }
 };
 
+struct HeldIntervals : public Expectation<StreamAndReassembler>
+{
+  std::vector<std::pair<uint64_t, uint64_t>> intervals_;
+  size_t max_count_;
+
+  explicit HeldIntervals( std::vector<std::pair<uint64_t, uint64_t>> intervals, size_t max_count = 4 )
+    : intervals_( std::move( intervals ) ), max_count_( max_count )
+  {}
+
+  std::string description() const override
+  {
+    std::ostringstream ss;
+    ss << "first " << max_count_ << " held intervals are";
+    for ( const auto& [begin, end] : intervals_ ) {
+      ss << " [" << begin << ", " << end << ")";
+    }
+    return ss.str();
+  }
+
+  void execute( StreamAndReassembler& sr ) const override
+  {
+    std::vector<std::pair<uint64_t, uint64_t>> got( max_count_ );
+    got.resize( sr.second.held_intervals( got ) );
+    if ( got != intervals_ ) {
+      std::ostringstream ss;
+      ss << "The Reassembler should have held" << ( intervals_.empty() ? " nothing" : "" );
+      for ( const auto& [begin, end] : intervals_ ) {
+        ss << " [" << begin << ", " << end << ")";
+      }
+      ss << ", but it held" << ( got.empty() ? " nothing" : "" );
+      for ( const auto& [begin, end] : got ) {
+        ss << " [" << begin << ", " << end << ")";
+      }
+      throw ExpectationViolation { ss.str() };
+    }
+  }
+};
+
 struct Insert : public Action<StreamAndReassembler>
 {
   std::string data_;
@@ -0,0 +1,90 @@
+#include "reassembler_test_harness.hh"
+
+#include <exception>
+#include <iostream>
+
+using namespace std;
+
+int main()
+{
+  try {
+    {
+      ReassemblerTestHarness test { "windowed holes", 65000, Reassembler::windowed() };
+
+      test.execute( Insert { "b", 1 } );
+      test.execute( Insert { "d", 3 } );
+      test.execute( BytesPending { 2 } );
+      test.execute( Insert { "c", 2 } );
+      test.execute( ReadAll( "" ) );
+      test.execute( Insert { "a", 0 } );
+      test.execute( BytesPending { 0 } );
+      test.execute( ReadAll( "abcd" ) );
+      test.execute( IsFinished { false } );
+    }
+
+    {
+      ReassemblerTestHarness test { "windowed overlapping", 1000, Reassembler::windowed() };
+
+      test.execute( Insert { "c", 2 } );
+      test.execute( Insert { "bcd", 1 } );
+      test.execute( BytesPending { 3 } );
+      test.execute( Insert { "defg", 3 } );
+      test.execute( BytesPending { 6 } );
+      test.execute( Insert { "abc", 0 } );
+      test.execute( BytesPending { 0 } );
+      test.execute( ReadAll( "abcdefg" ) );
+    }
+
+    {
+      ReassemblerTestHarness test { "windowed capacity", 8, Reassembler::windowed() };
+
+      test.execute( Insert { "ghijklmn", 6 } );
+      test.execute( BytesPending { 2 } );
+      test.execute( Insert { "abcdef", 0 } );
+      test.execute( BytesPushed( 8 ) );
+      test.execute( BytesPending { 0 } );
+      test.execute( ReadAll( "abcdefgh" ) );
+      test.execute( Insert { "ghijklmnop", 6 } );
+      test.execute( ReadAll( "ijklmnop" ) );
+    }
+
+    {
+      // Pending bytes 60..69 straddle the end of the 64-byte ring.
+      ReassemblerTestHarness test { "windowed wraparound", 100, Reassembler::windowed() };
+
+      test.execute( Insert { string( 50, 'x' ), 0 } );
+      test.execute( ReadAll( string( 50, 'x' ) ) );
+      test.execute( Insert { "0123456789", 60 } );
+      test.execute( BytesPending { 10 } );
+      test.execute( Insert { "abcdefghij", 50 } );
+      test.execute( BytesPending { 0 } );
+      test.execute( ReadAll( "abcdefghij0123456789" ) );
+    }
+
+    {
+      ReassemblerTestHarness test { "windowed growth", 1000, Reassembler::windowed() };
+
+      test.execute( Insert { "c", 2 } );
+      test.execute( Insert { "z", 500 } );
+      test.execute( BytesPending { 2 } );
+      test.execute( Insert { "ab", 0 } );
+      test.execute( ReadAll( "abc" ) );
+      test.execute( BytesPending { 1 } );
+    }
+
+    {
+      ReassemblerTestHarness test { "windowed last substring", 1000, Reassembler::windowed() };
+
+      test.execute( Insert { "b", 1 }.is_last() );
+      test.execute( IsFinished { false } );
+      test.execute( Insert { "a", 0 } );
+      test.execute( ReadAll( "ab" ) );
+      test.execute( IsFinished { true } );
+    }
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -8,6 +8,7 @@
 #include <optional>
 #include <sstream>
 #include <utility>
+#include <vector>
 
 using ReceiverSet = std::pair<StreamAndReassembler, TCPReceiver>;
 
@@ -28,10 +29,10 @@ struct ReceiverSetTestStep : public TestStep<ReceiverSet>
 class TCPReceiverTestHarness : public TestHarness<ReceiverSet>
 {
 public:
-  TCPReceiverTestHarness( std::string test_name, uint64_t capacity )
+  TCPReceiverTestHarness( std::string test_name, uint64_t capacity, TCPReceiver receiver = {} )
     : TestHarness( move( test_name ),
                    "capacity=" + std::to_string( capacity ),
-                   { { ByteStream { capacity }, Reassembler {} }, TCPReceiver {} } )
+                   { { ByteStream { capacity }, Reassembler {} }, std::move( receiver ) } )
   {}
 
   template<std::derived_from<TestStep<StreamAndReassembler>> T>
@@ -56,6 +57,23 @@ struct ExpectWindow : public ExpectNumber<ReceiverSet, uint16_t>
   uint16_t value( ReceiverSet& rs ) const override { return rs.second.send( rs.first.first.writer() ).window_size; }
 };
 
+struct ExpectWindowScale : public ExpectNumber<ReceiverSet, std::optional<uint8_t>>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "window_scale"; }
+  std::optional<uint8_t> value( ReceiverSet& rs ) const override
+  {
+    return rs.second.send( rs.first.first.writer() ).window_scale;
+  }
+};
+
+struct ExpectPeerWindowScale : public ExpectNumber<ReceiverSet, std::optional<uint8_t>>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "peer_window_scale"; }
+  std::optional<uint8_t> value( ReceiverSet& rs ) const override { return rs.second.peer_window_scale(); }
+};
+
 struct ExpectAckno : public ExpectNumber<ReceiverSet, std::optional<Wrap32>>
 {
   using ExpectNumber::ExpectNumber;
@@ -104,6 +122,37 @@ struct HasAckno : public ExpectBool<ReceiverSet>
   }
 };
 
+struct ExpectSACKBlocks : public Expectation<ReceiverSet>
+{
+  std::vector<std::pair<Wrap32, Wrap32>> blocks_;
+
+  explicit ExpectSACKBlocks( std::vector<std::pair<Wrap32, Wrap32>> blocks ) : blocks_( std::move( blocks ) ) {}
+
+  static std::string describe( const std::vector<std::pair<Wrap32, Wrap32>>& blocks )
+  {
+    std::ostringstream ss;
+    for ( const auto& [begin, end] : blocks ) {
+      ss << " [" << begin << ", " << end << ")";
+    }
+    return blocks.empty() ? " none" : ss.str();
+  }
+
+  std::string description() const override { return "SACK blocks are" + describe( blocks_ ); }
+
+  void execute( ReceiverSet& rs ) const override
+  {
+    const auto msg = rs.second.send( rs.first.first.writer() );
+    std::vector<std::pair<Wrap32, Wrap32>> got;
+    for ( size_t i = 0; i < msg.sack_block_count; i++ ) {
+      got.emplace_back( msg.sack_blocks.at( i ).begin, msg.sack_blocks.at( i ).end );
+    }
+    if ( got != blocks_ ) {
+      throw ExpectationViolation( "TCPReceiver should have sent SACK blocks" + describe( blocks_ ) + ", but sent"
+                                  + describe( got ) );
+    }
+  }
+};
+
 struct SegmentArrives : public Action<ReceiverSet>
 {
   TCPSenderMessage msg_ {};
@@ -121,6 +170,12 @@ struct SegmentArrives : public Action<ReceiverSet>
     return *this;
   }
 
+  SegmentArrives& with_window_scale( uint8_t scale )
+  {
+    msg_.window_scale = scale;
+    return *this;
+  }
+
   SegmentArrives& with_seqno( Wrap32 seqno_ )
   {
     msg_.seqno = seqno_;
@@ -131,7 +186,8 @@ struct SegmentArrives : public Action<ReceiverSet>
 
   SegmentArrives& with_data( std::string data )
   {
-    msg_.payload = move( data );
+    const uint64_t length = data.size();
+    msg_.payload = { Buffer { move( data ) }, 0, length };
     return *this;
   }
 
@@ -155,6 +211,9 @@ struct SegmentArrives : public Action<ReceiverSet>
     if ( msg_.SYN ) {
       ss << " +SYN";
     }
+    if ( msg_.window_scale.has_value() ) {
+      ss << " wscale=" << +msg_.window_scale.value();
+    }
     if ( not msg_.payload.empty() ) {
       ss << " payload=\"" << Printer::prettify( msg_.payload ) << "\"";
     }
@@ -0,0 +1,54 @@
+#include "random.hh"
+#include "receiver_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+
+    {
+      const uint32_t isn = uniform_int_distribution<uint32_t> { 0, UINT32_MAX }( rd );
+      TCPReceiverTestHarness test { "SACK blocks for out-of-order segments", 4000 };
+      test.execute( SegmentArrives {}.with_syn().with_seqno( isn ) );
+      test.execute( ExpectSACKBlocks { {} } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 11 ).with_data( "klmn" ) );
+      test.execute( SegmentArrives {}.with_seqno( isn + 5 ).with_data( "efg" ) );
+      test.execute( ExpectAckno { Wrap32 { isn + 1 } } );
+      test.execute( ExpectSACKBlocks { { { Wrap32 { isn + 5 }, Wrap32 { isn + 8 } },
+                                         { Wrap32 { isn + 11 }, Wrap32 { isn + 15 } } } } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 8 ).with_data( "hij" ) );
+      test.execute( ExpectSACKBlocks { { { Wrap32 { isn + 5 }, Wrap32 { isn + 15 } } } } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 1 ).with_data( "abcd" ) );
+      test.execute( ExpectAckno { Wrap32 { isn + 15 } } );
+      test.execute( ExpectSACKBlocks { {} } );
+      test.execute( ReadAll { "abcdefghijklmn" } );
+    }
+
+    {
+      const uint32_t isn = uniform_int_distribution<uint32_t> { 0, UINT32_MAX }( rd );
+      TCPReceiverTestHarness test { "at most four SACK blocks", 4000 };
+      test.execute( SegmentArrives {}.with_syn().with_seqno( isn ) );
+      for ( uint32_t i = 1; i <= 6; i++ ) {
+        test.execute( SegmentArrives {}.with_seqno( isn + 1 + 10 * i ).with_data( "x" ) );
+      }
+      test.execute( ExpectSACKBlocks { { { Wrap32 { isn + 11 }, Wrap32 { isn + 12 } },
+                                         { Wrap32 { isn + 21 }, Wrap32 { isn + 22 } },
+                                         { Wrap32 { isn + 31 }, Wrap32 { isn + 32 } },
+                                         { Wrap32 { isn + 41 }, Wrap32 { isn + 42 } } } } );
+      test.execute( BytesPending { 6 } );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
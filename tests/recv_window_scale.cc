@@ -0,0 +1,83 @@
+#include "receiver_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+using namespace std;
+
+int main()
+{
+  try {
+    TCPConfig scaling;
+    scaling.window_scaling = true;
+
+    {
+      const size_t cap = 1000000;
+      const uint32_t isn = 23452;
+      TCPReceiverTestHarness test { "no window scale unless the SYN offers one", cap, TCPReceiver { scaling } };
+      test.execute( ExpectWindow { 65535 } );
+      test.execute( ExpectWindowScale { {} } );
+      test.execute( SegmentArrives {}.with_syn().with_seqno( isn ) );
+      test.execute( ExpectWindow { 65535 } );
+      test.execute( ExpectWindowScale { {} } );
+      test.execute( ExpectPeerWindowScale { {} } );
+    }
+
+    {
+      const size_t cap = 1000000;
+      const uint32_t isn = 23452;
+      TCPReceiverTestHarness test { "no window scale unless our side offers one too", cap };
+      test.execute( SegmentArrives {}.with_syn().with_seqno( isn ).with_window_scale( 7 ) );
+      test.execute( ExpectWindow { 65535 } );
+      test.execute( ExpectWindowScale { {} } );
+      test.execute( ExpectPeerWindowScale { {} } );
+    }
+
+    {
+      const size_t cap = 1000000;
+      const uint32_t isn = 23452;
+      TCPReceiverTestHarness test { "scaled window advertises the whole capacity", cap, TCPReceiver { scaling } };
+      test.execute( SegmentArrives {}.with_syn().with_seqno( isn ).with_window_scale( 7 ) );
+      test.execute( ExpectAckno { Wrap32 { isn + 1 } } );
+      test.execute( ExpectPeerWindowScale { 7 } );
+      // 1000000 >> 4 = 62500 is the first shift that fits in 16 bits.
+      test.execute( ExpectWindowScale { 4 } );
+      test.execute( ExpectWindow { 62500 } );
+      test.execute( SegmentArrives {}.with_seqno( isn + 1 ).with_data( string( 100, 'x' ) ) );
+      test.execute( ExpectWindow { ( cap - 100 ) >> 4 } );
+      test.execute( ReadAll { string( 100, 'x' ) } );
+      test.execute( ExpectWindow { 62500 } );
+    }
+
+    {
+      const size_t cap = 4000;
+      const uint32_t isn = 23452;
+      TCPReceiverTestHarness test { "small capacity needs no scaling", cap, TCPReceiver { scaling } };
+      test.execute( SegmentArrives {}.with_syn().with_seqno( isn ).with_window_scale( 7 ) );
+      test.execute( ExpectWindowScale { 0 } );
+      test.execute( ExpectWindow { cap } );
+    }
+
+    {
+      const size_t cap = 4000;
+      const uint32_t isn = 23452;
+      TCPReceiverTestHarness test { "a peer's shift over 14 is taken as 14", cap, TCPReceiver { scaling } };
+      test.execute( SegmentArrives {}.with_syn().with_seqno( isn ).with_window_scale( 20 ) );
+      test.execute( ExpectPeerWindowScale { 14 } );
+    }
+
+    // The smallest shift that fits, and at most 14 (windows of up to 2^30 bytes).
+    if ( TCPReceiverMessage::window_scale_for( 65535 ) != 0 or TCPReceiverMessage::window_scale_for( 65536 ) != 1
+         or TCPReceiverMessage::window_scale_for( 1ULL << 40 ) != 14 ) {
+      throw runtime_error( "wrong window scale for capacity" );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << endl;
+    return 1;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,134 @@
+#include "byte_stream.hh"
+#include "tcp_sender.hh"
+#include "wrapping_integers.hh"
+
+#include <chrono>
+#include <cstddef>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace std;
+using namespace std::chrono;
+
+/*
+ * Measures the per-ack cost of the sender: unwrapping a window's worth of acknowledgment numbers one at a time
+ * versus with the batch Wrap32::unwrap(), and the full TCPSender::receive() path with one ack per segment.
+ */
+
+void report( const string& description, double ns_per_ack, double max_ns_per_ack )
+{
+  fstream debug_output;
+  debug_output.open( "/dev/tty" );
+
+  cout << description << " took " << fixed << setprecision( 1 ) << ns_per_ack << " ns per ack.\n";
+  debug_output << "             Per-ack cost (" << description << "): " << fixed << setprecision( 1 ) << ns_per_ack
+               << " ns\n";
+
+  if ( ns_per_ack > max_ns_per_ack ) {
+    throw runtime_error( description + " exceeded " + to_string( max_ns_per_ack ) + " ns per ack" );
+  }
+}
+
+void unwrap_speed_test( const bool batched, const size_t window, const size_t rounds, const size_t random_seed )
+{
+  default_random_engine rd { random_seed };
+  const Wrap32 isn { static_cast<uint32_t>( rd() ) };
+
+  // Acknowledgment numbers spread over a window just beyond the checkpoint, which crosses several wraps
+  vector<Wrap32> acknos;
+  uint64_t checkpoint = ( 1UL << 32 ) - window * rounds / 2;
+  for ( size_t i = 0; i < window; i++ ) {
+    acknos.push_back( Wrap32::wrap( checkpoint + rd() % 65536, isn ) );
+  }
+  vector<uint64_t> absolute_acknos( window );
+  uint64_t checksum = 0;
+
+  const auto start_time = steady_clock::now();
+  for ( size_t round = 0; round < rounds; round++ ) {
+    if ( batched ) {
+      Wrap32::unwrap( acknos, isn, checkpoint, absolute_acknos );
+    } else {
+      for ( size_t i = 0; i < window; i++ ) {
+        absolute_acknos[i] = acknos[i].unwrap( isn, checkpoint );
+      }
+    }
+    checksum += absolute_acknos[round % window];
+    checkpoint += window;
+  }
+  const auto stop_time = steady_clock::now();
+
+  if ( checksum == 0 ) {
+    throw runtime_error( "unwrap produced no results" );
+  }
+
+  const double seconds = duration_cast<duration<double>>( stop_time - start_time ).count();
+  report( batched ? "Wrap32::unwrap() batch of " + to_string( window )
+                  : "Wrap32::unwrap() one at a time, window of " + to_string( window ),
+          seconds * 1e9 / static_cast<double>( window * rounds ),
+          100 );
+}
+
+void sender_speed_test( const size_t rounds )
+{
+  // Start just short of the wrap so the acknowledgment numbers cross it
+  const Wrap32 isn { UINT32_MAX - 100000 };
+  TCPSender sender { 1000, isn };
+  ByteStream stream { 65535 };
+
+  const string data( 65535, 'x' );
+  vector<Wrap32> acknos;
+  size_t num_acks = 0;
+  duration<double> receive_time {};
+
+  for ( size_t round = 0; round <= rounds; round++ ) {
+    if ( round > 0 ) {
+      stream.writer().push( data.substr( 0, stream.writer().available_capacity() ) );
+    }
+    sender.push( stream.reader() );
+    acknos.clear();
+    while ( const auto msg = sender.maybe_send() ) {
+      acknos.push_back( msg->seqno + static_cast<uint32_t>( msg->sequence_length() ) );
+    }
+
+    const auto start_time = steady_clock::now();
+    for ( const auto ackno : acknos ) {
+      TCPReceiverMessage ack;
+      ack.ackno = ackno;
+      ack.window_size = 65535;
+      sender.receive( ack );
+    }
+    receive_time += steady_clock::now() - start_time;
+    num_acks += acknos.size();
+  }
+
+  if ( sender.sequence_numbers_in_flight() != 0 ) {
+    throw runtime_error( "TCPSender still has sequence numbers in flight after every segment was acked" );
+  }
+
+  report( "TCPSender::receive(), one ack per segment",
+          receive_time.count() * 1e9 / static_cast<double>( num_acks ),
+          10000 );
+}
+
+void program_body()
+{
+  for ( const bool batched : { false, true } ) {
+    unwrap_speed_test( batched, 64, 100000, 1370 );
+  }
+  sender_speed_test( 2000 );
+}
+
+int main()
+{
+  try {
+    program_body();
+  } catch ( const exception& e ) {
+    cerr << "Exception: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,252 @@
+#include "random.hh"
+#include "sender_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+using Algorithm = TCPConfig::CongestionAlgorithm;
+
+// Send every segment the sender will release, acknowledging each one as it goes out, then push again.
+struct SendAndAckAll : public Action<StreamAndSender>
+{
+  uint16_t window_;
+
+  explicit SendAndAckAll( uint16_t window ) : window_( window ) {}
+  std::string description() const override
+  {
+    return "send every segment, ack each one with win=" + to_string( window_ ) + ", then push";
+  }
+
+  void execute( StreamAndSender& ss ) const override
+  {
+    while ( const auto msg = ss.second.maybe_send() ) {
+      TCPReceiverMessage ack;
+      ack.ackno = msg->seqno + static_cast<uint32_t>( msg->sequence_length() );
+      ack.window_size = window_;
+      ss.second.receive( ack );
+      ss.second.push( ss.first.reader() );
+    }
+  }
+};
+
+// Acknowledge everything sent so far (e.g. the receiver already held all but the retransmitted segment).
+struct AckAll : public Action<StreamAndSender>
+{
+  uint16_t window_;
+
+  explicit AckAll( uint16_t window ) : window_( window ) {}
+  std::string description() const override
+  {
+    return "ack everything sent with win=" + to_string( window_ ) + ", then push";
+  }
+
+  void execute( StreamAndSender& ss ) const override
+  {
+    TCPReceiverMessage ack;
+    ack.ackno = ss.second.send_empty_message().seqno;
+    ack.window_size = window_;
+    ss.second.receive( ack );
+    ss.second.push( ss.first.reader() );
+  }
+};
+
+struct ReadCongestionWindow : public Action<StreamAndSender>
+{
+  uint64_t& cwnd_;
+
+  explicit ReadCongestionWindow( uint64_t& cwnd ) : cwnd_( cwnd ) {}
+  std::string description() const override { return "read congestion_window"; }
+  void execute( StreamAndSender& ss ) const override { cwnd_ = ss.second.congestion_window(); }
+};
+
+// Grow the window for a few round trips, lose one segment of a full window and recover it after a timeout, then
+// keep the pipe full for `round_trips` more round trips of 100 ms; returns the final congestion window.
+uint64_t cwnd_after_recovery( Algorithm algorithm, Wrap32 isn, size_t round_trips )
+{
+  TCPConfig cfg;
+  cfg.fixed_isn = isn;
+  cfg.congestion_algorithm = algorithm;
+
+  TCPSenderTestHarness test { "cwnd after recovery", cfg };
+  test.execute( Push {} );
+  test.execute( ExpectMessage {}.with_syn( true ) );
+  test.execute( AckReceived { isn + 1 }.with_win( 60000 ) );
+  for ( int i = 0; i < 2; i++ ) {
+    test.execute( Push { string( 20000, 'x' ) } );
+    test.execute( SendAndAckAll { 60000 } );
+    test.execute( Tick { 100 } );
+  }
+  test.execute( Push { string( 40000, 'x' ) } );
+  test.execute( SendAll {} );
+  test.execute( Tick { cfg.rt_timeout } );
+  test.execute( ExpectCongestionWindow { 1000 } );
+  test.execute( ExpectMessage {}.with_payload_size( 1000 ) );
+  test.execute( AckAll { 60000 } );
+  for ( size_t i = 0; i < round_trips; i++ ) {
+    test.execute( Tick { 100 } );
+    test.execute( Push { string( 20000, 'x' ) } );
+    test.execute( SendAndAckAll { 60000 } );
+  }
+
+  uint64_t cwnd = 0;
+  test.execute( ReadCongestionWindow { cwnd } );
+  return cwnd;
+}
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+
+      TCPSenderTestHarness test { "No congestion control by default", cfg };
+      test.execute( ExpectCongestionWindow { UINT64_MAX } );
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ) );
+      test.execute( AckReceived { isn + 1 }.with_win( 60000 ) );
+      test.execute( Push { string( 30000, 'x' ) } );
+      test.execute( ExpectSeqnosInFlight { 30000 } );
+    }
+
+    for ( const auto algorithm : { Algorithm::NewReno, Algorithm::CUBIC } ) {
+      const string name = algorithm == Algorithm::NewReno ? "NewReno" : "CUBIC";
+
+      {
+        TCPConfig cfg;
+        const Wrap32 isn( rd() );
+        cfg.fixed_isn = isn;
+        cfg.congestion_algorithm = algorithm;
+
+        TCPSenderTestHarness test { name + ": initial window and slow start", cfg };
+        test.execute( ExpectCongestionWindow { 10000 } );
+        test.execute( ExpectSlowStartThreshold { UINT64_MAX } );
+        test.execute( Push {} );
+        test.execute( ExpectMessage {}.with_syn( true ) );
+        test.execute( AckReceived { isn + 1 }.with_win( 60000 ) );
+        test.execute( ExpectCongestionWindow { 10001 } );
+        test.execute( Push { string( 20000, 'x' ) } );
+        test.execute( ExpectSeqnosInFlight { 10001 } );
+        for ( int i = 0; i < 10; i++ ) {
+          test.execute( ExpectMessage {}.with_no_flags().with_payload_size( 1000 ) );
+        }
+        test.execute( ExpectMessage {}.with_no_flags().with_payload_size( 1 ) );
+        test.execute( ExpectNoSegment {} );
+
+        // Each ack grows cwnd by at most one segment, however much it acknowledges.
+        test.execute( AckReceived { isn + 1 + 1000 }.with_win( 60000 ) );
+        test.execute( ExpectCongestionWindow { 11001 } );
+        test.execute( ExpectSeqnosInFlight { 11001 } );
+        test.execute( ExpectMessage {}.with_no_flags().with_payload_size( 1000 ) );
+        test.execute( ExpectMessage {}.with_no_flags().with_payload_size( 1000 ) );
+        test.execute( ExpectNoSegment {} );
+        test.execute( AckReceived { isn + 1 + 10001 }.with_win( 60000 ) );
+        test.execute( ExpectCongestionWindow { 12001 } );
+        test.execute( ExpectSeqnosInFlight { 9999 } );
+      }
+
+      {
+        TCPConfig cfg;
+        const Wrap32 isn( rd() );
+        cfg.fixed_isn = isn;
+        cfg.congestion_algorithm = algorithm;
+
+        TCPSenderTestHarness test { name + ": receive window still applies", cfg };
+        test.execute( Push {} );
+        test.execute( ExpectMessage {}.with_syn( true ) );
+        test.execute( AckReceived { isn + 1 }.with_win( 1500 ) );
+        test.execute( Push { string( 5000, 'x' ) } );
+        test.execute( ExpectSeqnosInFlight { 1500 } );
+        test.execute( ExpectMessage {}.with_no_flags().with_payload_size( 1000 ) );
+        test.execute( ExpectMessage {}.with_no_flags().with_payload_size( 500 ) );
+        test.execute( AckReceived { isn + 1001 }.with_win( 1500 ) );
+        test.execute( ExpectSeqnosInFlight { 1500 } );
+        test.execute( ExpectMessage {}.with_no_flags().with_payload_size( 1000 ) );
+        test.execute( ExpectNoSegment {} );
+      }
+
+      {
+        TCPConfig cfg;
+        const Wrap32 isn( rd() );
+        cfg.fixed_isn = isn;
+        cfg.congestion_algorithm = algorithm;
+
+        TCPSenderTestHarness test { name + ": timeout collapses the window", cfg };
+        test.execute( Push {} );
+        test.execute( ExpectMessage {}.with_syn( true ) );
+        test.execute( AckReceived { isn + 1 }.with_win( 60000 ) );
+        test.execute( Push { string( 10000, 'x' ) } );
+        for ( int i = 0; i < 10; i++ ) {
+          test.execute( ExpectMessage {}.with_no_flags().with_payload_size( 1000 ) );
+        }
+        test.execute( Tick { cfg.rt_timeout } );
+        // NewReno halves the data in flight; CUBIC keeps 0.7 of the window.
+        test.execute( ExpectSlowStartThreshold { algorithm == Algorithm::NewReno ? 5000U : 7000U } );
+        test.execute( ExpectCongestionWindow { 1000 } );
+        test.execute( ExpectMessage {}.with_no_flags().with_payload_size( 1000 ).with_seqno( isn + 1 ) );
+        test.execute( ExpectNoSegment {} );
+
+        // Slow start again from one segment.
+        test.execute( AckReceived { isn + 1 + 1000 }.with_win( 60000 ) );
+        test.execute( ExpectCongestionWindow { 2000 } );
+        test.execute( ExpectNoSegment {} );
+        test.execute( AckReceived { isn + 1 + 10000 }.with_win( 60000 ) );
+        test.execute( ExpectCongestionWindow { 3000 } );
+      }
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+      cfg.congestion_algorithm = Algorithm::NewReno;
+
+      TCPSenderTestHarness test { "NewReno: congestion avoidance is linear", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ) );
+      test.execute( AckReceived { isn + 1 }.with_win( 60000 ) );
+      test.execute( Push { string( 1000, 'x' ) } );
+      test.execute( ExpectMessage {}.with_payload_size( 1000 ) );
+      test.execute( Tick { cfg.rt_timeout } );
+      test.execute( ExpectSlowStartThreshold { 2000 } );
+      test.execute( ExpectCongestionWindow { 1000 } );
+      test.execute( SendAndAckAll { 60000 } );
+      test.execute( ExpectCongestionWindow { 2000 } );
+
+      // From here on, cwnd grows by one segment per cwnd of acknowledged data: reaching 15000 would take
+      // 2000 + 3000 + ... + 14000 = 104000 bytes, more than are acknowledged here.
+      for ( int i = 0; i < 5; i++ ) {
+        test.execute( Push { string( 20000, 'x' ) } );
+        test.execute( SendAndAckAll { 60000 } );
+      }
+      test.execute( ExpectSeqnosInFlight { 0 } );
+      test.execute( ExpectCongestionWindow { 14000 } );
+    }
+
+    {
+      // After a loss, CUBIC gets back towards the window where the loss happened sooner than NewReno.
+      const Wrap32 isn( rd() );
+      const uint64_t reno = cwnd_after_recovery( Algorithm::NewReno, isn, 20 );
+      const uint64_t cubic = cwnd_after_recovery( Algorithm::CUBIC, isn, 20 );
+      if ( cubic <= reno ) {
+        throw runtime_error( "CUBIC cwnd (" + to_string( cubic ) + ") did not outgrow NewReno's ("
+                             + to_string( reno ) + ") after recovery" );
+      }
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
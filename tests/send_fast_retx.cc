@@ -0,0 +1,161 @@
+#include "random.hh"
+#include "sender_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+using Algorithm = TCPConfig::CongestionAlgorithm;
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+      cfg.congestion_algorithm = Algorithm::NewReno;
+
+      TCPSenderTestHarness test { "NewReno: fast retransmit and fast recovery", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ) );
+      test.execute( AckReceived { isn + 1 }.with_win( 60000 ) );
+      test.execute( Push { string( 10000, 'x' ) } );
+      for ( int i = 0; i < 10; i++ ) {
+        test.execute( ExpectMessage {}.with_no_flags().with_payload_size( 1000 ) );
+      }
+
+      // The first segment is lost: each later one draws a duplicate ack.
+      test.execute( AckReceived { isn + 1 }.with_win( 60000 ) );
+      test.execute( AckReceived { isn + 1 }.with_win( 60000 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectFastRetransmissions { 0 } );
+      test.execute( AckReceived { isn + 1 }.with_win( 60000 ) );
+      test.execute( ExpectMessage {}.with_no_flags().with_seqno( isn + 1 ).with_payload_size( 1000 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectFastRetransmissions { 1 } );
+      test.execute( ExpectInFastRecovery { true } );
+      test.execute( ExpectSlowStartThreshold { 5000 } );
+      test.execute( ExpectCongestionWindow { 8000 } );
+
+      // Further duplicate acks inflate the window until new data fits.
+      test.execute( Push { string( 5000, 'x' ) } );
+      test.execute( ExpectNoSegment {} );
+      for ( int i = 0; i < 4; i++ ) {
+        test.execute( AckReceived { isn + 1 }.with_win( 60000 ) );
+      }
+      test.execute( ExpectCongestionWindow { 12000 } );
+      test.execute( ExpectMessage {}.with_no_flags().with_seqno( isn + 10001 ).with_payload_size( 1000 ) );
+      test.execute( ExpectMessage {}.with_no_flags().with_seqno( isn + 11001 ).with_payload_size( 1000 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectFastRetransmissions { 1 } );
+
+      // A partial ack: the fourth segment was lost too, and is resent at once.
+      test.execute( AckReceived { isn + 3001 }.with_win( 60000 ) );
+      test.execute( ExpectInFastRecovery { true } );
+      test.execute( ExpectCongestionWindow { 10000 } );
+      test.execute( ExpectMessage {}.with_no_flags().with_seqno( isn + 3001 ).with_payload_size( 1000 ) );
+      test.execute( ExpectMessage {}.with_no_flags().with_seqno( isn + 12001 ).with_payload_size( 1000 ) );
+      test.execute( ExpectNoSegment {} );
+
+      // Acknowledging everything sent before the loss ends recovery with about ssthresh in flight.
+      test.execute( AckReceived { isn + 10001 }.with_win( 60000 ) );
+      test.execute( ExpectInFastRecovery { false } );
+      test.execute( ExpectCongestionWindow { 4000 } );
+      test.execute( ExpectSeqnosInFlight { 4000 } );
+      test.execute( ExpectMessage {}.with_no_flags().with_seqno( isn + 13001 ).with_payload_size( 1000 ) );
+      test.execute( ExpectNoSegment {} );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+      cfg.congestion_algorithm = Algorithm::CUBIC;
+
+      TCPSenderTestHarness test { "CUBIC: fast retransmit reduces the window by beta", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ) );
+      test.execute( AckReceived { isn + 1 }.with_win( 60000 ) );
+      test.execute( Push { string( 10000, 'x' ) } );
+      for ( int i = 0; i < 10; i++ ) {
+        test.execute( ExpectMessage {}.with_no_flags().with_payload_size( 1000 ) );
+      }
+      for ( int i = 0; i < 3; i++ ) {
+        test.execute( AckReceived { isn + 1 }.with_win( 60000 ) );
+      }
+      test.execute( ExpectMessage {}.with_no_flags().with_seqno( isn + 1 ).with_payload_size( 1000 ) );
+      test.execute( ExpectSlowStartThreshold { 7000 } );
+      test.execute( ExpectCongestionWindow { 10000 } );
+      test.execute( AckReceived { isn + 10001 }.with_win( 60000 ) );
+      test.execute( ExpectInFastRecovery { false } );
+      test.execute( ExpectCongestionWindow { 2000 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+
+      TCPSenderTestHarness test { "Window updates and acks with nothing outstanding are not duplicates", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ) );
+      for ( int i = 0; i < 3; i++ ) {
+        test.execute( AckReceived { isn + 1 }.with_win( 1000 ) );
+      }
+      test.execute( Push { string( 4000, 'x' ) } );
+      test.execute( ExpectMessage {}.with_no_flags().with_payload_size( 1000 ) );
+      test.execute( AckReceived { isn + 1 }.with_win( 2000 ) );
+      test.execute( ExpectMessage {}.with_no_flags().with_payload_size( 1000 ) );
+      test.execute( AckReceived { isn + 1 }.with_win( 3000 ) );
+      test.execute( ExpectMessage {}.with_no_flags().with_payload_size( 1000 ) );
+      test.execute( AckReceived { isn + 1 }.with_win( 4000 ) );
+      test.execute( ExpectMessage {}.with_no_flags().with_payload_size( 1000 ) );
+      test.execute( AckReceived { isn + 1 }.with_win( 4000 ) );
+      test.execute( AckReceived { isn + 1 }.with_win( 4000 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectFastRetransmissions { 0 } );
+      test.execute( AckReceived { isn + 1 }.with_win( 4000 ) );
+      test.execute( ExpectMessage {}.with_no_flags().with_seqno( isn + 1 ).with_payload_size( 1000 ) );
+      test.execute( ExpectFastRetransmissions { 1 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+      cfg.congestion_algorithm = Algorithm::NewReno;
+
+      TCPSenderTestHarness test { "No second fast retransmit for losses from before a timeout", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ) );
+      test.execute( AckReceived { isn + 1 }.with_win( 60000 ) );
+      test.execute( Push { string( 5000, 'x' ) } );
+      for ( int i = 0; i < 5; i++ ) {
+        test.execute( ExpectMessage {}.with_no_flags().with_payload_size( 1000 ) );
+      }
+      test.execute( Tick { cfg.rt_timeout } );
+      test.execute( ExpectMessage {}.with_no_flags().with_seqno( isn + 1 ).with_payload_size( 1000 ) );
+
+      // Duplicate acks still arriving for the original flight do not trigger another retransmission.
+      test.execute( AckReceived { isn + 2001 }.with_win( 60000 ) );
+      for ( int i = 0; i < 3; i++ ) {
+        test.execute( AckReceived { isn + 2001 }.with_win( 60000 ) );
+      }
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectFastRetransmissions { 0 } );
+      test.execute( ExpectInFastRecovery { false } );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,103 @@
+#include "random.hh"
+#include "sender_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+
+      TCPSenderTestHarness test { "No pacing by default", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ) );
+      test.execute( Tick { 5 } );
+      test.execute( AckReceived { isn + 1 }.with_win( 10000 ) );
+      test.execute( Push { string( 10000, 'x' ) } );
+      for ( int i = 0; i < 10; i++ ) {
+        test.execute( ExpectMessage {}.with_no_flags().with_payload_size( 1000 ) );
+      }
+      test.execute( ExpectNextRelease { 5 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+      cfg.pacing_rate = 100000; // 100 bytes per millisecond
+
+      TCPSenderTestHarness test { "Pacing at a fixed rate", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ) );
+      test.execute( AckReceived { isn + 1 }.with_win( 60000 ) );
+      test.execute( Push { string( 10000, 'x' ) } );
+
+      // The bucket starts with a burst of two segments' worth.
+      test.execute( ExpectMessage {}.with_no_flags().with_payload_size( 1000 ) );
+      test.execute( ExpectMessage {}.with_no_flags().with_payload_size( 1000 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectNextRelease { 1 } );
+      test.execute( Tick { 1 } );
+      test.execute( ExpectMessage {}.with_no_flags().with_payload_size( 1000 ) );
+      test.execute( ExpectNoSegment {} );
+
+      // From then on, one segment every 10 ms.
+      for ( uint64_t t = 11; t <= 71; t += 10 ) {
+        test.execute( ExpectNextRelease { t } );
+        test.execute( Tick { 9 } );
+        test.execute( ExpectNoSegment {} );
+        test.execute( Tick { 1 } );
+        test.execute( ExpectMessage {}.with_no_flags().with_payload_size( 1000 ) );
+        test.execute( ExpectNoSegment {} );
+      }
+      test.execute( ExpectSeqnosInFlight { 10000 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+      cfg.pacing = true;
+
+      TCPSenderTestHarness test { "Pacing spreads the window over the smoothed RTT", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ) );
+      test.execute( Tick { 100 } );
+      test.execute( AckReceived { isn + 1 }.with_win( 10000 ) );
+      test.execute( ExpectSmoothedRTT { 100 } );
+      test.execute( ExpectPacingRate { 100000 } );
+
+      test.execute( Push { string( 10000, 'x' ) } );
+      for ( int i = 0; i < 3; i++ ) {
+        test.execute( ExpectMessage {}.with_no_flags().with_payload_size( 1000 ) );
+      }
+      test.execute( ExpectNoSegment {} );
+      for ( uint64_t t = 110; t <= 170; t += 10 ) {
+        test.execute( ExpectNextRelease { t } );
+        test.execute( Tick { 10 } );
+        test.execute( ExpectMessage {}.with_no_flags().with_payload_size( 1000 ) );
+        test.execute( ExpectNoSegment {} );
+      }
+
+      // A smaller window means a lower rate.
+      test.execute( AckReceived { isn + 1 }.with_win( 5000 ) );
+      test.execute( ExpectPacingRate { 50000 } );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
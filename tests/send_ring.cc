@@ -0,0 +1,176 @@
+#include "random.hh"
+#include "retransmission_ring.hh"
+#include "sender_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// Send every segment the sender will release, keeping them.
+struct SendAndKeep : public Action<StreamAndSender>
+{
+  vector<TCPSenderMessage>& sent_;
+
+  explicit SendAndKeep( vector<TCPSenderMessage>& sent ) : sent_( sent ) {}
+  std::string description() const override { return "send every segment"; }
+  void execute( StreamAndSender& ss ) const override
+  {
+    while ( auto msg = ss.second.maybe_send() ) {
+      sent_.push_back( move( *msg ) );
+    }
+  }
+};
+
+// The next segment resends an earlier one from the same bytes, not from a copy of them.
+struct ExpectRetransmissionOf : public Expectation<StreamAndSender>
+{
+  const vector<TCPSenderMessage>& sent_;
+  size_t index_;
+
+  ExpectRetransmissionOf( const vector<TCPSenderMessage>& sent, size_t index ) : sent_( sent ), index_( index ) {}
+  std::string description() const override { return "retransmission of segment " + to_string( index_ ); }
+  void execute( StreamAndSender& ss ) const override
+  {
+    const auto msg = ss.second.maybe_send();
+    const TCPSenderMessage& original = sent_.at( index_ );
+    if ( not msg.has_value() or msg->seqno != original.seqno ) {
+      throw ExpectationViolation( "TCPSender should have retransmitted segment " + to_string( index_ ) );
+    }
+    if ( msg->payload.view().data() != original.payload.view().data() ) {
+      throw ExpectationViolation( "TCPSender copied the payload of segment " + to_string( index_ ) );
+    }
+  }
+};
+
+void expect( bool condition, const string& what )
+{
+  if ( not condition ) {
+    throw runtime_error( "RetransmissionRing: " + what );
+  }
+}
+
+void ring_test()
+{
+  RetransmissionRing ring;
+  const uint64_t capacity = ring.capacity();
+  ByteStream stream { 2 * capacity };
+  const auto append = [&]( const string& data ) {
+    stream.writer().push( data );
+    return ring.append( stream.reader(), data.size() );
+  };
+
+  vector<BufferSlice> slices;
+  for ( char c = 'a'; c < 'k'; c++ ) {
+    slices.push_back( append( string( 1000, c ) ) );
+  }
+  expect( ring.bytes_in_use() == 10000, "appends are not counted" );
+  for ( size_t i = 0; i < 8; i++ ) {
+    ring.release( slices.at( i ) );
+    slices.at( i ) = {}; // Nothing outside the ring holds the space any more
+  }
+
+  // Too big for the space before the end, so it wraps around to the space released at the start.
+  const BufferSlice wrapped = append( string( capacity - 10000 + 1, 'x' ) );
+  expect( wrapped.offset == 0 and ring.capacity() == capacity, "did not wrap around" );
+  expect( wrapped.view() == string( capacity - 10000 + 1, 'x' ), "wrapped bytes differ" );
+
+  // No room anywhere: a bigger buffer, with the old slices still intact.
+  const BufferSlice grown = append( string( 8000, 'y' ) );
+  expect( ring.capacity() == 2 * capacity and grown.offset == 0, "did not grow" );
+  expect( slices.at( 9 ).view() == string( 1000, 'j' ), "outgrown slice changed" );
+  expect( wrapped.view() == string( capacity - 10000 + 1, 'x' ), "outgrown wrapped slice changed" );
+  expect( ring.bytes_in_use() == 8000, "outgrown bytes are counted" );
+  ring.release( slices.at( 8 ) );
+  expect( ring.bytes_in_use() == 8000, "releasing an outgrown slice changed the new buffer" );
+
+  // Released space that a copy of a slice still refers to is not written again.
+  ring.release( grown );
+  const BufferSlice next = append( string( 8000, 'z' ) );
+  expect( grown.view() == string( 8000, 'y' ), "reused the space of a slice held outside the ring" );
+  expect( next.view() == string( 8000, 'z' ), "bytes appended after a held slice differ" );
+}
+
+int main()
+{
+  try {
+    ring_test();
+
+    auto rd = get_random_engine();
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+      vector<TCPSenderMessage> sent;
+
+      TCPSenderTestHarness test { "Retransmissions share the bytes of the first transmission", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ) );
+      test.execute( AckReceived { isn + 1 }.with_win( 60000 ) );
+      test.execute( Push { string( 3000, 'a' ) + string( 3000, 'b' ) } );
+      test.execute( SendAndKeep { sent } );
+      test.execute( Tick { cfg.rt_timeout } );
+      test.execute( ExpectRetransmissionOf { sent, 0 } );
+      test.execute( AckReceived { isn + 3001 }.with_win( 60000 ) );
+      test.execute( Tick { 2U * cfg.rt_timeout } );
+      test.execute( ExpectRetransmissionOf { sent, 3 } );
+      if ( sent.at( 3 ).payload.view() != string( 1000, 'b' ) ) {
+        throw runtime_error( "wrong payload for segment 3" );
+      }
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+      vector<TCPSenderMessage> sent;
+
+      TCPSenderTestHarness test { "A kept message survives its ack and a refill", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ) );
+      test.execute( AckReceived { isn + 1 }.with_win( 60000 ) );
+      test.execute( Push { "AAAAA" } );
+      test.execute( SendAndKeep { sent } );
+      test.execute( AckReceived { isn + 6 }.with_win( 60000 ) );
+      test.execute( Push { "BBBBB" } );
+      test.execute( ExpectMessage {}.with_data( "BBBBB" ) );
+      if ( sent.at( 0 ).payload.view() != "AAAAA" ) {
+        throw runtime_error( "a sent payload changed after its bytes were acknowledged" );
+      }
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+
+      // More than the ring's initial capacity in flight, then acked and reused many times over.
+      TCPSenderTestHarness test { "Stream through the ring", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ) );
+      test.execute( AckReceived { isn + 1 }.with_win( 60000 ) );
+      uint64_t acked = 1;
+      for ( int round = 0; round < 20; round++ ) {
+        const string data( 50000, static_cast<char>( 'a' + round ) );
+        test.execute( Push { data } );
+        for ( int i = 0; i < 50; i++ ) {
+          test.execute( ExpectMessage {}.with_data( string( 1000, data.front() ) ) );
+        }
+        acked += data.size();
+        test.execute( AckReceived { isn + static_cast<uint32_t>( acked ) }.with_win( 60000 ) );
+        test.execute( ExpectSeqnosInFlight { 0 } );
+      }
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,186 @@
+#include "random.hh"
+#include "sender_test_harness.hh"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+
+      TCPSenderTestHarness test { "RTT is measured, but the RTO stays fixed by default", cfg };
+      test.execute( ExpectSmoothedRTT { {} } );
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ) );
+      test.execute( Tick { 50 } );
+      test.execute( AckReceived { isn + 1 } );
+      test.execute( ExpectSmoothedRTT { 50 } );
+      test.execute( ExpectRTO { cfg.rt_timeout } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+      cfg.adaptive_rt_timeout = true;
+      cfg.min_rt_timeout = 10;
+
+      TCPSenderTestHarness test { "RTO follows the RFC 6298 estimate", cfg };
+      test.execute( ExpectRTO { cfg.rt_timeout } );
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ) );
+      test.execute( Tick { 50 } );
+      test.execute( AckReceived { isn + 1 } );
+      // First sample: SRTT = R, RTTVAR = R / 2, RTO = SRTT + 4 * RTTVAR
+      test.execute( ExpectSmoothedRTT { 50 } );
+      test.execute( ExpectRTO { 150 } );
+
+      test.execute( Push { "abc" } );
+      test.execute( ExpectMessage {}.with_data( "abc" ) );
+      test.execute( Tick { 30 } );
+      test.execute( AckReceived { isn + 4 } );
+      // RTTVAR = 3/4 * 25 + 1/4 * 20 = 23.75, SRTT = 7/8 * 50 + 1/8 * 30 = 47.5, RTO = 142.5 rounded
+      test.execute( ExpectSmoothedRTT { 47.5 } );
+      test.execute( ExpectRTO { 143 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+      cfg.adaptive_rt_timeout = true;
+      cfg.min_rt_timeout = 10;
+
+      TCPSenderTestHarness test { "Karn's rule: no samples from retransmitted segments", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ) );
+      test.execute( Tick { 50 } );
+      test.execute( AckReceived { isn + 1 } );
+      test.execute( ExpectRTO { 150 } );
+
+      test.execute( Push { "abc" } );
+      test.execute( ExpectMessage {}.with_data( "abc" ) );
+      test.execute( Tick { 149 } );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Tick { 1 } );
+      test.execute( ExpectMessage {}.with_data( "abc" ) );
+      test.execute( ExpectRTO { 300 } );
+      test.execute( Tick { 10 } );
+      test.execute( AckReceived { isn + 4 } );
+      // The ack could be for either transmission: no sample, and the backed-off RTO is kept.
+      test.execute( ExpectSmoothedRTT { 50 } );
+      test.execute( ExpectRTO { 300 } );
+
+      test.execute( Push { "def" } );
+      test.execute( ExpectMessage {}.with_data( "def" ) );
+      test.execute( Tick { 50 } );
+      test.execute( AckReceived { isn + 7 } );
+      // RTTVAR = 3/4 * 25 = 18.75, SRTT = 50, RTO = 50 + 75
+      test.execute( ExpectSmoothedRTT { 50 } );
+      test.execute( ExpectRTO { 125 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+      cfg.adaptive_rt_timeout = true;
+
+      TCPSenderTestHarness test { "RTO is clamped to the default minimum", cfg };
+      test.execute( RoundTrips { 5, 100 } );
+      test.execute( ExpectRTTConverged { 5 } );
+      test.execute( ExpectRTO { 200 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+      cfg.adaptive_rt_timeout = true;
+      cfg.max_rt_timeout = 100;
+
+      TCPSenderTestHarness test { "RTO is clamped to the configured maximum", cfg };
+      test.execute( RoundTrips { 50, 1 } );
+      test.execute( ExpectSmoothedRTT { 50 } );
+      test.execute( ExpectRTO { 100 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+      cfg.adaptive_rt_timeout = true;
+      cfg.max_rt_timeout = 5000;
+
+      TCPSenderTestHarness test { "Backoff is clamped to the configured maximum", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ) );
+      uint64_t RTO = cfg.rt_timeout;
+      for ( int i = 0; i < 6; i++ ) {
+        test.execute( ExpectRTO { RTO } );
+        test.execute( Tick { RTO - 1 } );
+        test.execute( ExpectNoSegment {} );
+        test.execute( Tick { 1 } );
+        test.execute( ExpectMessage {}.with_syn( true ) );
+        RTO = min( 2 * RTO, cfg.max_rt_timeout );
+      }
+      test.execute( ExpectRTO { 5000 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+      cfg.adaptive_rt_timeout = true;
+      cfg.min_rt_timeout = 1;
+
+      TCPSenderTestHarness test { "Convergence on a fixed 5 ms path", cfg };
+      test.execute( RoundTrips { 5, 1 } );
+      test.execute( ExpectRTO { 15 } );
+      test.execute( RoundTrips { 5, 100 } );
+      test.execute( ExpectRTTConverged { 5 } );
+      // RTTVAR has decayed to nothing, leaving SRTT plus the clock granularity.
+      test.execute( ExpectRTO { 6 } );
+
+      // A loss is now retransmitted after 6 ms instead of a second.
+      test.execute( Push { "lost" } );
+      test.execute( ExpectMessage {}.with_data( "lost" ) );
+      test.execute( Tick { 5 } );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Tick { 1 } );
+      test.execute( ExpectMessage {}.with_data( "lost" ) );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+      cfg.adaptive_rt_timeout = true;
+      cfg.min_rt_timeout = 1;
+
+      TCPSenderTestHarness test { "Convergence after the path RTT changes", cfg };
+      test.execute( RoundTrips { 80, 100 } );
+      test.execute( ExpectRTTConverged { 80 } );
+      test.execute( RoundTrips { 20, 100 } );
+      test.execute( ExpectRTTConverged { 20 } );
+      test.execute( ExpectRTO { 21 } );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,122 @@
+#include "random.hh"
+#include "sender_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+using Algorithm = TCPConfig::CongestionAlgorithm;
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+
+      TCPSenderTestHarness test { "SACK: every hole in a window is resent within one round trip", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ) );
+      test.execute( AckReceived { isn + 1 }.with_win( 60000 ) );
+      test.execute( Push { string( 10000, 'x' ) } );
+      for ( int i = 0; i < 10; i++ ) {
+        test.execute( ExpectMessage {}.with_no_flags().with_payload_size( 1000 ) );
+      }
+
+      // Segments 1, 4 and 7 are lost; the receiver reports the rest as they arrive.
+      const auto ack = [&] { return AckReceived { isn + 1 }.with_win( 60000 ); };
+      test.execute( ack().with_sack( isn + 1001, isn + 2001 ) );
+      test.execute( ack().with_sack( isn + 1001, isn + 3001 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ack().with_sack( isn + 1001, isn + 3001 ).with_sack( isn + 4001, isn + 5001 ) );
+      test.execute( ExpectMessage {}.with_seqno( isn + 1 ).with_payload_size( 1000 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ack().with_sack( isn + 1001, isn + 3001 ).with_sack( isn + 4001, isn + 6001 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ack().with_sack( isn + 1001, isn + 3001 ).with_sack( isn + 4001, isn + 6001 ).with_sack(
+        isn + 7001, isn + 8001 ) );
+      test.execute( ExpectMessage {}.with_seqno( isn + 3001 ).with_payload_size( 1000 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ack().with_sack( isn + 1001, isn + 3001 ).with_sack( isn + 4001, isn + 6001 ).with_sack(
+        isn + 7001, isn + 10001 ) );
+      test.execute( ExpectMessage {}.with_seqno( isn + 6001 ).with_payload_size( 1000 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectSeqnosSacked { 7000 } );
+      test.execute( ExpectFastRetransmissions { 1 } );
+
+      test.execute( AckReceived { isn + 10001 }.with_win( 60000 ) );
+      test.execute( ExpectSeqnosInFlight { 0 } );
+      test.execute( ExpectSeqnosSacked { 0 } );
+      test.execute( ExpectInFastRecovery { false } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+      cfg.congestion_algorithm = Algorithm::NewReno;
+
+      TCPSenderTestHarness test { "SACK: after a timeout, the holes go out as cwnd allows", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ) );
+      test.execute( AckReceived { isn + 1 }.with_win( 60000 ) );
+      test.execute( Push { string( 4000, 'x' ) } );
+      for ( int i = 0; i < 4; i++ ) {
+        test.execute( ExpectMessage {}.with_no_flags().with_payload_size( 1000 ) );
+      }
+
+      // Segments 1 and 3 are lost: too few duplicate acks for a fast retransmit.
+      const auto ack = [&] {
+        return AckReceived { isn + 1 }.with_win( 60000 ).with_sack( isn + 1001, isn + 2001 );
+      };
+      test.execute( ack() );
+      test.execute( ack().with_sack( isn + 3001, isn + 4001 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( Tick { cfg.rt_timeout } );
+      test.execute( ExpectCongestionWindow { 1000 } );
+      test.execute( ExpectMessage {}.with_seqno( isn + 1 ).with_payload_size( 1000 ) );
+      test.execute( ExpectNoSegment {} );
+
+      // The ack for the first hole opens cwnd for the second, without waiting for another timeout.
+      test.execute( AckReceived { isn + 2001 }.with_win( 60000 ).with_sack( isn + 3001, isn + 4001 ) );
+      test.execute( ExpectCongestionWindow { 2000 } );
+      test.execute( ExpectMessage {}.with_seqno( isn + 2001 ).with_payload_size( 1000 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( AckReceived { isn + 4001 }.with_win( 60000 ) );
+      test.execute( ExpectSeqnosInFlight { 0 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+
+      TCPSenderTestHarness test { "SACK: blocks beyond what was sent, or covering part of a segment", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectMessage {}.with_syn( true ) );
+      test.execute( AckReceived { isn + 1 }.with_win( 60000 ) );
+      test.execute( Push { string( 3000, 'x' ) } );
+      for ( int i = 0; i < 3; i++ ) {
+        test.execute( ExpectMessage {}.with_no_flags().with_payload_size( 1000 ) );
+      }
+      test.execute( AckReceived { isn + 1 }.with_win( 60000 ).with_sack( isn + 5001, isn + 6001 ) );
+      test.execute( ExpectSeqnosSacked { 0 } );
+      test.execute( AckReceived { isn + 1 }.with_win( 60000 ).with_sack( isn + 1001, isn + 1501 ) );
+      test.execute( ExpectSeqnosSacked { 0 } );
+      test.execute( AckReceived { isn + 1 }.with_win( 60000 ).with_sack( isn + 1001, isn + 2001 ) );
+      test.execute( ExpectSeqnosSacked { 1000 } );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
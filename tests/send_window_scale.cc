@@ -0,0 +1,118 @@
+#include "random.hh"
+#include "sender_test_harness.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <optional>
+#include <string>
+
+using namespace std;
+
+// The next segment is a SYN offering `scale` (or no window scaling at all).
+struct ExpectSynWindowScale : public Expectation<StreamAndSender>
+{
+  optional<uint8_t> scale_;
+
+  explicit ExpectSynWindowScale( optional<uint8_t> scale ) : scale_( scale ) {}
+  std::string description() const override
+  {
+    return scale_.has_value() ? "SYN offering wscale=" + to_string( +scale_.value() ) : "SYN without wscale";
+  }
+  void execute( StreamAndSender& ss ) const override
+  {
+    const auto msg = ss.second.maybe_send();
+    if ( not msg.has_value() or not msg->SYN ) {
+      throw ExpectationViolation( "TCPSender should have sent a SYN" );
+    }
+    if ( msg->window_scale != scale_ ) {
+      throw ExpectationViolation( "TCPSender offered the wrong window scale on its SYN" );
+    }
+  }
+};
+
+int main()
+{
+  try {
+    auto rd = get_random_engine();
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+      cfg.send_capacity = 1 << 20;
+
+      TCPSenderTestHarness test { "A window scale is ignored unless offered", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectSynWindowScale { {} } );
+      test.execute( AckReceived { isn + 1 }.with_win( 1000 ).with_window_scale( 4 ) );
+      test.execute( Push { string( 5000, 'x' ) } );
+      test.execute( ExpectMessage {}.with_no_flags().with_payload_size( 1000 ) );
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectSeqnosInFlight { 1000 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+      cfg.window_scaling = true;
+      cfg.recv_capacity = 16777216;
+      cfg.send_capacity = 1 << 20;
+
+      TCPSenderTestHarness test { "The SYN offers a scale for the receive capacity", cfg };
+      test.execute( Push {} );
+      // 16777216 >> 9 = 32768 is the first shift that fits in 16 bits.
+      test.execute( ExpectSynWindowScale { 9 } );
+      test.execute( AckReceived { isn + 1 }.with_win( 1000 ).with_window_scale( 6 ) );
+      test.execute( Push { string( 70000, 'x' ) } );
+      for ( int i = 0; i < 64; i++ ) {
+        test.execute( ExpectMessage {}.with_no_flags().with_payload_size( 1000 ) );
+      }
+      test.execute( ExpectNoSegment {} );
+      test.execute( ExpectSeqnosInFlight { 64000 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+      cfg.window_scaling = true;
+      cfg.send_capacity = 2 << 20;
+
+      TCPSenderTestHarness test { "Windows over 65535 bytes", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectSynWindowScale { 0 } );
+      test.execute( AckReceived { isn + 1 }.with_win( 4096 ).with_window_scale( 8 ) );
+      test.execute( Push { string( 2000000, 'x' ) } );
+      test.execute( ExpectSeqnosInFlight { 1 << 20 } );
+      test.execute( SendAll {} );
+
+      // Acknowledging (about) half of it opens the window again by as much.
+      test.execute( AckReceived { isn + 1 + 524000 }.with_win( 4096 ).with_window_scale( 8 ) );
+      test.execute( ExpectSeqnosInFlight { 1 << 20 } );
+    }
+
+    {
+      TCPConfig cfg;
+      const Wrap32 isn( rd() );
+      cfg.fixed_isn = isn;
+      cfg.window_scaling = true;
+      cfg.send_capacity = 1 << 20;
+
+      TCPSenderTestHarness test { "A window scale over 14 is taken as 14", cfg };
+      test.execute( Push {} );
+      test.execute( ExpectSynWindowScale { 0 } );
+      test.execute( AckReceived { isn + 1 }.with_win( 2 ).with_window_scale( 20 ) );
+      test.execute( Push { string( 40000, 'x' ) } );
+      test.execute( SendAll {} );
+      test.execute( ExpectSeqnosInFlight { 2 << 14 } );
+    }
+  } catch ( const exception& e ) {
+    cerr << e.what() << endl;
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
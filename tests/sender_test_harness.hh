@@ -6,6 +6,7 @@
 #include "tcp_sender.hh"
 #include "wrapping_integers.hh"
 
+#include <cmath>
 #include <optional>
 #include <sstream>
 #include <utility>
@@ -54,6 +55,98 @@ struct ExpectSeqnosInFlight : public ExpectNumber<StreamAndSender, uint64_t>
   uint64_t value( StreamAndSender& ss ) const override { return ss.second.sequence_numbers_in_flight(); }
 };
 
+struct ExpectCongestionWindow : public ExpectNumber<StreamAndSender, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "congestion_window"; }
+  uint64_t value( StreamAndSender& ss ) const override { return ss.second.congestion_window(); }
+};
+
+struct ExpectSlowStartThreshold : public ExpectNumber<StreamAndSender, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "slow_start_threshold"; }
+  uint64_t value( StreamAndSender& ss ) const override { return ss.second.slow_start_threshold(); }
+};
+
+struct ExpectFastRetransmissions : public ExpectNumber<StreamAndSender, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "fast_retransmissions"; }
+  uint64_t value( StreamAndSender& ss ) const override { return ss.second.fast_retransmissions(); }
+};
+
+struct ExpectSeqnosSacked : public ExpectNumber<StreamAndSender, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "sequence_numbers_sacked"; }
+  uint64_t value( StreamAndSender& ss ) const override { return ss.second.sequence_numbers_sacked(); }
+};
+
+struct ExpectPacingRate : public ExpectNumber<StreamAndSender, double>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "pacing_rate"; }
+  double value( StreamAndSender& ss ) const override { return ss.second.pacing_rate(); }
+};
+
+struct ExpectNextRelease : public ExpectNumber<StreamAndSender, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "next_release_ms"; }
+  uint64_t value( StreamAndSender& ss ) const override { return ss.second.next_release_ms(); }
+};
+
+struct ExpectInFastRecovery : public ExpectBool<StreamAndSender>
+{
+  using ExpectBool::ExpectBool;
+  std::string name() const override { return "in_fast_recovery"; }
+  bool value( StreamAndSender& ss ) const override { return ss.second.in_fast_recovery(); }
+};
+
+struct ExpectRTO : public ExpectNumber<StreamAndSender, uint64_t>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "RTO_ms"; }
+  uint64_t value( StreamAndSender& ss ) const override { return ss.second.RTO_ms(); }
+};
+
+struct ExpectSmoothedRTT : public ExpectNumber<StreamAndSender, std::optional<double>>
+{
+  using ExpectNumber::ExpectNumber;
+  std::string name() const override { return "smoothed_RTT_ms"; }
+  std::optional<double> value( StreamAndSender& ss ) const override { return ss.second.smoothed_RTT_ms(); }
+};
+
+// The RTT estimate has settled on a path whose RTT is always `rtt_ms`: SRTT is within `tolerance` of it, and
+// RTTVAR within `tolerance` of zero.
+struct ExpectRTTConverged : public Expectation<StreamAndSender>
+{
+  uint64_t rtt_ms_;
+  double tolerance_;
+
+  explicit ExpectRTTConverged( uint64_t rtt_ms, double tolerance = 0.5 )
+    : rtt_ms_( rtt_ms ), tolerance_( tolerance )
+  {}
+
+  std::string description() const override
+  {
+    return "RTT estimate converged to " + std::to_string( rtt_ms_ ) + " ms";
+  }
+
+  void execute( StreamAndSender& ss ) const override
+  {
+    const auto srtt = ss.second.smoothed_RTT_ms();
+    const double rttvar = ss.second.RTT_variation_ms();
+    if ( not srtt.has_value() or std::abs( *srtt - static_cast<double>( rtt_ms_ ) ) > tolerance_
+         or rttvar > tolerance_ ) {
+      throw ExpectationViolation( "RTT estimate did not converge to " + std::to_string( rtt_ms_ )
+                                  + " ms: smoothed_RTT_ms = " + to_string( srtt )
+                                  + ", RTT_variation_ms = " + std::to_string( rttvar ) );
+    }
+  }
+};
+
 struct ExpectNoSegment : public Expectation<StreamAndSender>
 {
   std::string description() const override { return "nothing to send"; }
@@ -154,7 +247,14 @@ struct Receive : public Action<StreamAndSender>
   std::string description() const override
   {
     std::ostringstream desc;
-    desc << "receive(ack=" << to_string( msg_.ackno ) << ", win=" << msg_.window_size << ")";
+    desc << "receive(ack=" << to_string( msg_.ackno ) << ", win=" << msg_.window_size;
+    if ( msg_.window_scale.has_value() ) {
+      desc << ", wscale=" << +msg_.window_scale.value();
+    }
+    for ( size_t i = 0; i < msg_.sack_block_count; i++ ) {
+      desc << ", sack=[" << msg_.sack_blocks.at( i ).begin << ", " << msg_.sack_blocks.at( i ).end << ")";
+    }
+    desc << ")";
     if ( push_ ) {
       desc << ", then push stream to TCPSender";
     }
@@ -175,6 +275,18 @@ struct Receive : public Action<StreamAndSender>
     }
   }
 
+  Receive& with_window_scale( uint8_t scale )
+  {
+    msg_.window_scale = scale;
+    return *this;
+  }
+
+  Receive& with_sack( Wrap32 begin, Wrap32 end )
+  {
+    msg_.sack_blocks.at( msg_.sack_block_count++ ) = { begin, end };
+    return *this;
+  }
+
   Receive& without_push()
   {
     push_ = false;
@@ -187,6 +299,54 @@ struct AckReceived : public Receive
   explicit AckReceived( Wrap32 ackno ) : Receive( { ackno, DEFAULT_TEST_WINDOW } ) {}
 };
 
+// Send every segment the sender will release, without acknowledging any of them.
+struct SendAll : public Action<StreamAndSender>
+{
+  std::string description() const override { return "send every segment"; }
+  void execute( StreamAndSender& ss ) const override
+  {
+    while ( ss.second.maybe_send().has_value() ) {}
+  }
+};
+
+// Simulate `count` round trips over a path with a fixed RTT: push `bytes_per_trip` bytes, send every segment
+// the sender releases, let `rtt_ms` pass, then acknowledge everything sent.
+struct RoundTrips : public Action<StreamAndSender>
+{
+  uint64_t rtt_ms_;
+  size_t count_;
+  size_t bytes_per_trip_;
+  uint16_t window_;
+
+  RoundTrips( uint64_t rtt_ms,          // NOLINT(bugprone-easily-swappable-parameters)
+              size_t count,             // NOLINT(bugprone-easily-swappable-parameters)
+              size_t bytes_per_trip = 1000,
+              uint16_t window = UINT16_MAX )
+    : rtt_ms_( rtt_ms ), count_( count ), bytes_per_trip_( bytes_per_trip ), window_( window )
+  {}
+
+  std::string description() const override
+  {
+    std::ostringstream desc;
+    desc << count_ << " round trips of " << rtt_ms_ << " ms, " << bytes_per_trip_ << " bytes each";
+    return desc.str();
+  }
+
+  void execute( StreamAndSender& ss ) const override
+  {
+    for ( size_t i = 0; i < count_; i++ ) {
+      ss.first.writer().push( std::string( bytes_per_trip_, 'x' ) );
+      ss.second.push( ss.first.reader() );
+      while ( ss.second.maybe_send().has_value() ) {}
+      ss.second.tick( rtt_ms_ );
+      TCPReceiverMessage ack;
+      ack.ackno = ss.second.send_empty_message().seqno;
+      ack.window_size = window_;
+      ss.second.receive( ack );
+    }
+  }
+};
+
 struct Close : public Push
 {
   Close() : Push( "" ) { with_close(); }
@@ -307,6 +467,6 @@ public:
   TCPSenderTestHarness( std::string name, TCPConfig config )
     : TestHarness( move( name ),
                    "initial_RTO_ms=" + to_string( config.rt_timeout ),
-                   { ByteStream { config.send_capacity }, TCPSender { config.rt_timeout, config.fixed_isn } } )
+                   { ByteStream { config.send_capacity }, TCPSender { config } } )
   {}
 };
@@ -30,6 +30,24 @@ int main()
       test_should_be( Wrap32( n ) != Wrap32( m ), n != m );
     }
 
+    // Serial-number ordering across the wrap
+    test_should_be( Wrap32( UINT32_MAX ) < Wrap32( 0 ), true );
+    test_should_be( Wrap32( 0 ) - Wrap32( UINT32_MAX ), 1 );
+    test_should_be( Wrap32( 5 ) - Wrap32( UINT32_MAX - 4 ), 10 );
+    test_should_be( Wrap32( UINT32_MAX - 4 ) - Wrap32( 5 ), -10 );
+    static_assert( Wrap32( 1 ) < Wrap32( 2 ) and Wrap32( 2 ) > Wrap32( 1 ) and Wrap32( 2 ) <= Wrap32( 2 ) );
+
+    for ( size_t i = 0; i < N_REPS; i++ ) {
+      const uint32_t n = rd();
+      const int32_t diff = static_cast<int32_t>( rd() % ( 1U << 31 ) ) - INT32_MAX / 2;
+      const Wrap32 a { n };
+      const Wrap32 b = a + static_cast<uint32_t>( diff );
+      test_should_be( b - a, diff );
+      test_should_be( a - b, -diff );
+      test_should_be( a < b, diff > 0 );
+      test_should_be( a >= b, diff <= 0 );
+    }
+
   } catch ( const exception& e ) {
     cerr << e.what() << endl;
     return 1;
@@ -1,3 +1,4 @@
+#include "random.hh"
 #include "test_should_be.hh"
 #include "wrapping_integers.hh"
 
@@ -6,6 +7,7 @@
 #include <iostream>
 #include <stdexcept>
 #include <string>
+#include <vector>
 
 using namespace std;
 
@@ -36,6 +38,21 @@ int main()
     // Nearly big unwrap with non-zero ISN
     test_should_be( Wrap32( UINT32_MAX ).unwrap( Wrap32( 1UL << 31 ), 0 ),
                     static_cast<uint64_t>( UINT32_MAX ) >> 1 );
+
+    // Batch unwrap agrees with unwrapping one at a time
+    auto rd = get_random_engine();
+    for ( const uint64_t checkpoint : { 0UL, 1UL << 31, 3 * ( 1UL << 32 ) - 7, uint64_t { rd() } << 16 } ) {
+      const Wrap32 zero_point( rd() );
+      vector<Wrap32> seqnos;
+      for ( size_t i = 0; i < 1000; i++ ) {
+        seqnos.emplace_back( rd() );
+      }
+      vector<uint64_t> absolute_seqnos( seqnos.size() );
+      Wrap32::unwrap( seqnos, zero_point, checkpoint, absolute_seqnos );
+      for ( size_t i = 0; i < seqnos.size(); i++ ) {
+        test_should_be( absolute_seqnos[i], seqnos[i].unwrap( zero_point, checkpoint ) );
+      }
+    }
   } catch ( const exception& e ) {
     cerr << e.what() << endl;
     return 1;
@@ -1,7 +1,9 @@
 #pragma once
 
+#include <cstdint>
 #include <memory>
 #include <string>
+#include <string_view>
 
 class Buffer
 {
@@ -20,4 +22,18 @@ public:
   size_t size() const { return buffer_->size(); }
   size_t length() const { return buffer_->length(); }
   bool empty() const { return buffer_->empty(); }
+  long use_count() const { return buffer_.use_count(); } // How many Buffers (and slices) share the bytes
+};
+
+// `length` bytes at `offset` in a Buffer. Copying a slice shares the Buffer rather than the bytes.
+struct BufferSlice
+{
+  Buffer buffer {};
+  uint64_t offset = 0;
+  uint64_t length = 0;
+
+  std::string_view view() const { return std::string_view( buffer ).substr( offset, length ); }
+  operator std::string_view() const { return view(); } // NOLINT(*-explicit-*)
+  size_t size() const { return length; }
+  bool empty() const { return length == 0; }
 };
@@ -6,6 +6,7 @@
 #include <fcntl.h>
 #include <iostream>
 #include <stdexcept>
+#include <sys/sendfile.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <sys/uio.h>
@@ -106,6 +107,30 @@ void FileDescriptor::read( string& buffer )
   buffer.resize( bytes_read );
 }
 
+// buffer is caller-owned memory to be filled; nothing is allocated
+size_t FileDescriptor::read( span<char> buffer )
+{
+  const ssize_t bytes_read = ::read( fd_num(), buffer.data(), buffer.size() );
+  if ( bytes_read < 0 ) {
+    if ( internal_fd_->non_blocking_ and ( errno == EAGAIN or errno == EINPROGRESS ) ) {
+      return 0;
+    }
+    throw unix_error { "read" };
+  }
+
+  register_read();
+
+  if ( bytes_read == 0 and not buffer.empty() ) {
+    internal_fd_->eof_ = true;
+  }
+
+  if ( bytes_read > static_cast<ssize_t>( buffer.size() ) ) {
+    throw runtime_error( "read() read more than requested" );
+  }
+
+  return bytes_read;
+}
+
 void FileDescriptor::read( vector<unique_ptr<string>>& buffers )
 {
   if ( buffers.empty() ) {
@@ -180,6 +205,46 @@ size_t FileDescriptor::write( const vector<string_view>& buffers )
   return bytes_written;
 }
 
+size_t FileDescriptor::splice( FileDescriptor& out, size_t len, optional<off_t> out_offset )
+{
+  loff_t offset = out_offset.value_or( 0 );
+  const ssize_t bytes_moved
+    = ::splice( fd_num(), nullptr, out.fd_num(), out_offset.has_value() ? &offset : nullptr, len, SPLICE_F_MOVE );
+  if ( bytes_moved < 0 ) {
+    if ( ( internal_fd_->non_blocking_ or out.internal_fd_->non_blocking_ )
+         and ( errno == EAGAIN or errno == EINPROGRESS ) ) {
+      return 0;
+    }
+    throw unix_error { "splice" };
+  }
+
+  register_read();
+  out.register_write();
+
+  if ( bytes_moved == 0 and len != 0 ) {
+    internal_fd_->eof_ = true;
+  }
+
+  if ( bytes_moved > static_cast<ssize_t>( len ) ) {
+    throw runtime_error( "splice() moved more than requested" );
+  }
+
+  return bytes_moved;
+}
+
+size_t FileDescriptor::sendfile( FileDescriptor& in, off_t in_offset, size_t len )
+{
+  const ssize_t bytes_sent = CheckSystemCall( "sendfile", ::sendfile( fd_num(), in.fd_num(), &in_offset, len ) );
+  in.register_read();
+  register_write();
+
+  if ( bytes_sent > static_cast<ssize_t>( len ) ) {
+    throw runtime_error( "sendfile() sent more than requested" );
+  }
+
+  return bytes_sent;
+}
+
 void FileDescriptor::set_blocking( bool blocking )
 {
   int flags = CheckSystemCall( "fcntl", fcntl( fd_num(), F_GETFL ) ); // NOLINT(*-vararg)
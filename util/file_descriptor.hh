@@ -3,6 +3,8 @@
 #include <cstddef>
 #include <limits>
 #include <memory>
+#include <optional>
+#include <span>
 #include <vector>
 
 // A reference-counted handle to a file descriptor
@@ -64,12 +66,20 @@ public:
   // Read into `buffer`
   void read( std::string& buffer );
   void read( std::vector<std::unique_ptr<std::string>>& buffers );
+  size_t read( std::span<char> buffer ); // Read into caller-owned memory; returns number of bytes read
 
   // Attempt to write a buffer
   // returns number of bytes written
   size_t write( std::string_view buffer );
   size_t write( const std::vector<std::string_view>& buffers );
 
+  // Zero-copy transfers: the bytes move between kernel buffers without entering user space.
+  // splice() moves up to `len` bytes from this descriptor to `out` (at `out_offset` if given); one must be a pipe.
+  // sendfile() writes up to `len` bytes of `in` (a file or memfd), starting at `in_offset`, to this descriptor.
+  // Both return the number of bytes moved.
+  size_t splice( FileDescriptor& out, size_t len, std::optional<off_t> out_offset = {} );
+  size_t sendfile( FileDescriptor& in, off_t in_offset, size_t len );
+
   // Close the underlying file descriptor
   void close() { internal_fd_->close(); }
 
@@ -15,8 +15,23 @@ public:
   static constexpr uint16_t TIMEOUT_DFLT = 1000;    //!< Default re-transmit timeout is 1 second
   static constexpr unsigned MAX_RETX_ATTEMPTS = 8;  //!< Maximum re-transmit attempts before giving up
 
+  //! Congestion control used by the TCPSender (None: limited by the receive window only)
+  enum class CongestionAlgorithm
+  {
+    None,
+    NewReno,
+    CUBIC
+  };
+
   uint16_t rt_timeout = TIMEOUT_DFLT;      //!< Initial value of the retransmission timeout, in milliseconds
+  bool adaptive_rt_timeout = false;        //!< Derive the timeout from measured round-trip times (RFC 6298)
+  uint64_t min_rt_timeout = 200;           //!< Lower bound on the adaptive timeout, in milliseconds
+  uint64_t max_rt_timeout = 60000;         //!< Upper bound on the adaptive timeout, in milliseconds
+  bool pacing = false;                     //!< Spread each window of segments over the smoothed round-trip time
+  uint64_t pacing_rate = 0;                //!< Or pace at this fixed rate, in bytes per second (0: not fixed)
+  bool window_scaling = false;             //!< Offer RFC 7323 window scaling on SYN, for windows over 65535 bytes
   size_t recv_capacity = DEFAULT_CAPACITY; //!< Receive capacity, in bytes
   size_t send_capacity = DEFAULT_CAPACITY; //!< Sender capacity, in bytes
   std::optional<Wrap32> fixed_isn {};
+  CongestionAlgorithm congestion_algorithm = CongestionAlgorithm::None;
 };
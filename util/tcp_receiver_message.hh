@@ -2,23 +2,64 @@
 
 #include "wrapping_integers.hh"
 
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
 #include <optional>
 
 /*
  * The TCPReceiverMessage structure contains the information sent from a TCP receiver to its sender.
  *
- * It contains two fields:
+ * It contains these fields:
  *
  * 1) The acknowledgment number (ackno): the *next* sequence number needed by the TCP Receiver.
  *    This is an optional field that is empty if the TCPReceiver hasn't yet received the Initial Sequence Number.
  *
  * 2) The window size. This is the number of sequence numbers that the TCP receiver is interested
- *    to receive, starting from the ackno if present. The maximum value is 65,535 (UINT16_MAX from
- *    the <cstdint> header).
+ *    to receive, starting from the ackno if present, shifted right by the window scale if there is one.
+ *    The maximum value is 65,535 (UINT16_MAX from the <cstdint> header).
+ *
+ * 3) Optionally, up to four SACK blocks: ranges of sequence numbers beyond the ackno that the receiver already
+ *    holds, lowest first, so the sender can retransmit only what is missing.
+ *
+ * 4) The window scale (RFC 7323): present only if both SYNs offered window scaling, the sender's and the
+ *    receiver's own side's. The window in this message is window_size << window_scale sequence numbers,
+ *    with a window_scale over 14 taken as 14.
  */
 
+// The sequence numbers [begin, end) of data held by the receiver
+struct SACKBlock
+{
+  Wrap32 begin { 0 };
+  Wrap32 end { 0 };
+};
+
 struct TCPReceiverMessage
 {
+  static constexpr size_t MAX_SACK_BLOCKS = 4;
+  static constexpr uint8_t MAX_WINDOW_SCALE = 14;
+
+  // The smallest window scale at which a 16-bit window_size can advertise `capacity` bytes (RFC 7323, 2.3)
+  static constexpr uint8_t window_scale_for( uint64_t capacity )
+  {
+    uint8_t scale = 0;
+    while ( scale < MAX_WINDOW_SCALE and ( capacity >> scale ) > UINT16_MAX ) {
+      scale++;
+    }
+    return scale;
+  }
+
   std::optional<Wrap32> ackno {};
   uint16_t window_size {};
+  std::array<SACKBlock, MAX_SACK_BLOCKS> sack_blocks {};
+  uint8_t sack_block_count {}; // number of valid entries at the front of sack_blocks
+  std::optional<uint8_t> window_scale {};
+
+  // The window in sequence numbers, scaled if the sender offered window scaling on its SYN
+  uint64_t window( bool scaling_offered ) const
+  {
+    const uint8_t scale = scaling_offered ? std::min( window_scale.value_or( 0 ), MAX_WINDOW_SCALE ) : 0;
+    return static_cast<uint64_t>( window_size ) << scale;
+  }
 };
@@ -3,6 +3,8 @@
 #include "buffer.hh"
 #include "wrapping_integers.hh"
 
+#include <cstdint>
+#include <optional>
 #include <string>
 
 /*
@@ -16,17 +18,23 @@
  * 2) The SYN flag. If set, it means this segment is the beginning of the byte stream, and that
  *    the seqno field contains the Initial Sequence Number (ISN) -- the zero point.
  *
- * 3) The payload: a substring (possibly empty) of the byte stream.
+ * 3) The payload: a substring (possibly empty) of the byte stream, as a slice of a shared Buffer (for a
+ *    TCPSender's messages, its retransmission ring). The bytes stay valid and unchanged for as long as the
+ *    message (or any copy of the slice) is kept, even after they are acknowledged.
  *
  * 4) The FIN flag. If set, it means the payload represents the ending of the byte stream.
+ *
+ * 5) On a SYN, optionally an RFC 7323 window scale offer: the sender can handle windows beyond 65,535 bytes,
+ *    and the value is the scale its own side would apply to the windows it advertises.
  */
 
 struct TCPSenderMessage
 {
   Wrap32 seqno { 0 };
   bool SYN { false };
-  Buffer payload {};
+  BufferSlice payload {};
   bool FIN { false };
+  std::optional<uint8_t> window_scale {};
 
   // How many sequence numbers does this segment use?
   size_t sequence_length() const { return SYN + payload.size() + FIN; }